@@ -0,0 +1,116 @@
+// the A/B benchmark of bar implementations, see bench_ab.cpp
+//
+// Every implementation gets its own translation unit with a run_<name>() function, since they all
+// call their bar progress::Progress. The loop itself is the same template for all of them.
+#pragma once
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+
+#include "common.hpp"
+
+namespace bench::ab {
+
+// operator new calls, counted by bench_ab.cpp
+inline std::atomic<int64_t> allocations{0};
+
+struct Config {
+    std::string_view name;
+    int64_t iterations;
+    // 0 for ticks = iterations
+    int64_t ticks;
+    bool show_bar;
+};
+
+struct Result {
+    double ns_per_iteration{0};
+    int64_t renders{0};
+    int64_t bytes{0};
+    int64_t allocations{0};
+};
+
+// writes to a file descriptor, like a buffered std::cout would. Counts the bytes, and the renders
+// by the '\r' every line ends with
+class FdBuffer : public std::streambuf {
+public:
+    explicit FdBuffer(int fd) : m_fd(fd) { setp(m_buffer, m_buffer + sizeof(m_buffer)); }
+    ~FdBuffer() override { sync(); }
+
+    int64_t bytes{0};
+    int64_t renders{0};
+
+protected:
+    int overflow(int c) override {
+        if (sync() != 0) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        const char *data = pbase();
+        auto size = static_cast<std::size_t>(pptr() - pbase());
+        bytes += static_cast<int64_t>(size);
+        renders += std::count(data, data + size, '\r');
+        while (size > 0) {
+            ssize_t written = ::write(m_fd, data, size);
+            if (written <= 0) {
+                return -1;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        setp(m_buffer, m_buffer + sizeof(m_buffer));
+        return 0;
+    }
+
+private:
+    int m_fd;
+    char m_buffer[4096];
+};
+
+// one warm up run, then one measured
+template <typename Bar, typename Setup>
+Result measure(const Config &config, int fd, Setup &&setup) {
+    Result result;
+    for (int run = 0; run < 2; run++) {
+        FdBuffer buffer(fd);
+        std::ostream stream(&buffer);
+        int64_t allocated = allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        {
+            int64_t ticks = config.ticks > 0 ? config.ticks : config.iterations;
+            Bar bar(config.iterations, ticks, stream);
+            setup(bar);
+            bar.show_bar(config.show_bar);
+            for (auto i : bar) {
+                do_not_optimize(i);
+            }
+        }
+        stream.flush();
+        auto finish = std::chrono::steady_clock::now();
+        result.ns_per_iteration = std::chrono::duration<double, std::nano>(finish - start).count() /
+                                  static_cast<double>(config.iterations);
+        result.renders = buffer.renders;
+        result.bytes = buffer.bytes;
+        result.allocations = allocations.load(std::memory_order_relaxed) - allocated;
+    }
+    return result;
+}
+
+// the implementations, one translation unit each
+Result run_progress(const Config &config, int fd);
+Result run_compare(const Config &config, int fd);
+
+}  // namespace bench::ab
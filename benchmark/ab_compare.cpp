@@ -0,0 +1,28 @@
+// compare.hpp for bench_ab
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// compare.hpp has a progress::Progress too. Another namespace, so the linker doesn't pick one
+// version of the inline functions for both
+#define progress compare
+#include "compare.hpp"
+#undef progress
+
+#include "ab.hpp"
+
+namespace bench::ab {
+
+Result run_compare(const Config &config, int fd) {
+    return measure<compare::Progress>(config, fd, [](compare::Progress &) {});
+}
+
+}  // namespace bench::ab
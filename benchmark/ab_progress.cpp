@@ -0,0 +1,15 @@
+// progress.hpp for bench_ab
+
+#include "progress.hpp"
+
+#include "ab.hpp"
+
+namespace bench::ab {
+
+Result run_progress(const Config &config, int fd) {
+    // the same '\r' lines as compare.hpp, not the log lines it would pick for a pipe
+    return measure<progress::Progress>(
+        config, fd, [](progress::Progress &bar) { bar.output(progress::Output::terminal); });
+}
+
+}  // namespace bench::ab
@@ -0,0 +1,162 @@
+/* progress.hpp against compare.hpp (and whatever comes next) in the same loops, to three outputs */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#include "ab.hpp"
+
+// every allocation in the process, the bars' and the streams' alike
+void *operator new(std::size_t size) {
+    bench::ab::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using bench::ab::Config;
+using bench::ab::Result;
+
+struct Implementation {
+    std::string_view name;
+    Result (*run)(const Config &, int);
+};
+
+// add new ones here
+constexpr Implementation implementations[] = {
+    {"progress.hpp", bench::ab::run_progress},
+    {"compare.hpp", bench::ab::run_compare},
+};
+
+// compare.hpp multiplies counter and ticks in 32 bits, ticks = total has to stay below 46341
+constexpr Config configs[] = {
+    {"ticks(1)", 10'000'000, 1, true},
+    {"ticks(100)", 10'000'000, 100, true},
+    {"ticks(100) no bar", 10'000'000, 100, false},
+    {"ticks(total)", 40'000, 0, true},
+    {"ticks(total) no bar", 40'000, 0, false},
+};
+
+[[noreturn]] void fail(const char *what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// reads whatever comes out of fd until it's closed, like a terminal or a `| cat` would
+std::thread drain(int fd) {
+    return std::thread([fd] {
+        char buffer[65536];
+        while (::read(fd, buffer, sizeof(buffer)) > 0) {
+        }
+    });
+}
+
+struct Output {
+    std::string_view name;
+    // what the bars write to
+    int fd{-1};
+    // the other end, for pipe and pty
+    int reader{-1};
+    std::thread drainer;
+
+    ~Output() {
+        ::close(fd);
+        if (drainer.joinable()) {
+            drainer.join();
+        }
+        if (reader >= 0) {
+            ::close(reader);
+        }
+    }
+};
+
+void open_null(Output &output) {
+    output.name = "/dev/null";
+    if ((output.fd = ::open("/dev/null", O_WRONLY)) < 0) {
+        fail("/dev/null");
+    }
+}
+
+void open_pipe(Output &output) {
+    output.name = "pipe";
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        fail("pipe");
+    }
+    output.reader = fds[0];
+    output.fd = fds[1];
+    output.drainer = drain(output.reader);
+}
+
+void open_pty(Output &output) {
+    output.name = "pty";
+    output.reader = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (output.reader < 0 || ::grantpt(output.reader) != 0 || ::unlockpt(output.reader) != 0) {
+        fail("pty");
+    }
+    const char *name = ::ptsname(output.reader);
+    if (name == nullptr || (output.fd = ::open(name, O_WRONLY | O_NOCTTY)) < 0) {
+        fail("pty");
+    }
+    // the master side reads until the slave is closed, then gets EIO
+    output.drainer = drain(output.reader);
+}
+
+void print(std::string_view implementation, std::string_view config, std::string_view output,
+           const Result &result) {
+    std::cout << std::left << std::setw(14) << implementation << std::setw(21) << config
+              << std::setw(11) << output << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << result.ns_per_iteration << std::setw(10) << result.renders
+              << std::setw(12) << result.bytes << std::setw(8) << result.allocations << '\n';
+}
+
+}  // namespace
+
+int main() {
+    std::cout << std::left << std::setw(14) << "" << std::setw(21) << "" << std::setw(11) << ""
+              << std::right << std::setw(10) << "ns/iter" << std::setw(10) << "renders"
+              << std::setw(12) << "bytes" << std::setw(8) << "allocs" << '\n';
+
+    // the loop without any bar, what everything else is measured against
+    {
+        constexpr int64_t iterations = 10'000'000;
+        Result bare;
+        int64_t allocated = bench::ab::allocations.load(std::memory_order_relaxed);
+        bare.ns_per_iteration = bench::ns_per_iteration(iterations, [] {
+            for (int64_t i = 0; i < iterations; i++) {
+                bench::do_not_optimize(i);
+            }
+        });
+        bare.allocations = bench::ab::allocations.load(std::memory_order_relaxed) - allocated;
+        print("bare loop", "", "", bare);
+    }
+
+    for (auto open : {open_null, open_pipe, open_pty}) {
+        Output output;
+        open(output);
+        for (const Config &config : configs) {
+            for (const Implementation &implementation : implementations) {
+                print(implementation.name, config.name, output.name,
+                      implementation.run(config, output.fd));
+            }
+        }
+        std::cout.flush();
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+/* cost per call of the clocks a Progress can use, and the drift of tsc_clock() from steady_clock */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "common.hpp"
+#include "progress.hpp"
+
+namespace {
+
+template <typename Now>
+void cost(std::string_view name, Now now) {
+    constexpr int64_t calls = 10'000'000;
+    double ns = bench::ns_per_iteration(calls, [&] {
+        for (int64_t i = 0; i < calls; i++) {
+            bench::do_not_optimize(now());
+        }
+    });
+    std::cout << name << ": " << ns << " ns/call\n";
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    // how long to watch the drift, pass more for a long run
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+    bench::NullBuffer null_buffer;
+    std::ostream null_stream(&null_buffer);
+
+    std::cout << "tsc usable: " << (progress::tsc_usable() ? "yes" : "no") << "\n";
+    cost("steady_clock   ", [] { return std::chrono::steady_clock::now(); });
+    cost("default_clock()", progress::default_clock);
+    cost("tsc_clock()    ", progress::tsc_clock);
+
+    // what it means for an instrument(1) loop
+    constexpr int32_t iterations = 10'000'000;
+    std::pair<std::string_view, progress::Clock> clocks[] = {
+        {"default_clock()", progress::default_clock}, {"tsc_clock()    ", progress::tsc_clock}};
+    for (auto [name, clock] : clocks) {
+        double ns = bench::ns_per_iteration(iterations, [&, clock = clock] {
+            progress::Progress bar(iterations, 100, null_stream);
+            bar.output(progress::Output::terminal).clock(clock).instrument(1);
+            for (int32_t i : bar) {
+                bench::do_not_optimize(i);
+            }
+        });
+        std::cout << "instrument(1), " << name << ": " << ns << " ns/iteration\n";
+    }
+
+    // both clocks measure the same stretches of time
+    auto steady_start = std::chrono::steady_clock::now();
+    auto tsc_start = progress::tsc_clock();
+    for (int second = 1; second <= seconds; second++) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        auto steady = std::chrono::steady_clock::now() - steady_start;
+        auto tsc = progress::tsc_clock() - tsc_start;
+        double drift = std::chrono::duration<double, std::micro>(tsc - steady).count();
+        std::cout << "after " << std::chrono::duration<double>(steady).count()
+                  << " s: tsc_clock() - steady_clock = " << drift << " us ("
+                  << drift / std::chrono::duration<double, std::micro>(steady).count() * 1e6
+                  << " ppm)\n";
+    }
+    return 0;
+}
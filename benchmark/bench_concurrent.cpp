@@ -0,0 +1,56 @@
+/* scaling of ConcurrentProgress::add() from 1 to N threads against the same loop without a bar */
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "common.hpp"
+#include "concurrent.hpp"
+
+namespace {
+
+// splits iterations over threads and runs body(i) for each one
+template <typename Body>
+void run(int32_t iterations, unsigned threads, Body &&body) {
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            for (int32_t i = static_cast<int32_t>(t); i < iterations;
+                 i += static_cast<int32_t>(threads)) {
+                body(i);
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+}  // namespace
+
+int main() {
+    constexpr int32_t iterations = 100'000'000;
+    bench::NullBuffer null_buffer;
+    std::ostream null_stream(&null_buffer);
+
+    unsigned max_threads = std::max(4U, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        double bare = bench::ns_per_iteration(iterations, [&] {
+            run(iterations, threads, [](int32_t i) { bench::do_not_optimize(i); });
+        });
+        double bar = bench::ns_per_iteration(iterations, [&] {
+            progress::ConcurrentProgress bar(iterations, null_stream);
+            bar.bar().output(progress::Output::terminal);
+            run(iterations, threads, [&](int32_t i) {
+                bench::do_not_optimize(i);
+                bar.add();
+            });
+        });
+        std::cout << threads << " threads: bare " << bare << " ns/iteration, bar " << bar
+                  << " ns/iteration, overhead " << bar - bare << " ns\n";
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/* progress::parallel_for against std::for_each(std::execution::par) and OpenMP on the same loops */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(BENCH_HAVE_TBB)
+#include <execution>
+#endif
+
+#include "common.hpp"
+#include "parallel.hpp"
+
+namespace {
+
+// the same work for every index
+void uniform(int64_t i) {
+    double x = static_cast<double>(i);
+    for (int k = 0; k < 16; k++) {
+        x = std::sqrt(x + 1.);
+    }
+    bench::do_not_optimize(x);
+}
+
+// every 64th index costs 256 times as much, so an even split leaves some threads idle
+void skewed(int64_t i) {
+    double x = static_cast<double>(i);
+    int rounds = i % 64 == 0 ? 4096 : 16;
+    for (int k = 0; k < rounds; k++) {
+        x = std::sqrt(x + 1.);
+    }
+    bench::do_not_optimize(x);
+}
+
+template <typename Body>
+void compare(std::string_view name, int64_t n, Body body, std::ostream &null_stream) {
+    std::vector<int64_t> indices(static_cast<std::size_t>(n));
+    std::iota(indices.begin(), indices.end(), 0);
+
+    double serial = bench::ns_per_iteration(n, [&] {
+        for (int64_t i = 0; i < n; i++) {
+            body(i);
+        }
+    });
+    std::cout << name << ", serial             : " << serial << " ns/iteration\n";
+
+#if defined(BENCH_HAVE_TBB)
+    double par = bench::ns_per_iteration(n, [&] {
+        std::for_each(std::execution::par, indices.begin(), indices.end(), body);
+    });
+    std::cout << name << ", std::execution::par: " << par << " ns/iteration\n";
+#endif
+
+#if defined(BENCH_HAVE_OPENMP)
+    double omp = bench::ns_per_iteration(n, [&] {
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int64_t i = 0; i < n; i++) {
+            body(i);
+        }
+    });
+    std::cout << name << ", openmp dynamic     : " << omp << " ns/iteration\n";
+#endif
+
+    double ours = bench::ns_per_iteration(
+        n, [&] { progress::parallel_for(n, body, {.report = false}, null_stream); });
+    std::cout << name << ", parallel_for       : " << ours << " ns/iteration\n";
+
+    double each = bench::ns_per_iteration(n, [&] {
+        progress::parallel_for_each(indices, body, {.report = false}, null_stream);
+    });
+    std::cout << name << ", parallel_for_each  : " << each << " ns/iteration\n";
+}
+
+}  // namespace
+
+int main() {
+    constexpr int64_t iterations = 10'000'000;
+    bench::NullBuffer null_buffer;
+    std::ostream null_stream(&null_buffer);
+
+    std::cout << std::thread::hardware_concurrency() << " threads\n";
+    compare("uniform", iterations, uniform, null_stream);
+    compare("skewed ", iterations / 16, skewed, null_stream);
+    return 0;
+}
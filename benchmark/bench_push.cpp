@@ -0,0 +1,70 @@
+/* microbenchmark for the per-iteration cost of Progress::push() against a bare for loop */
+
+#include <cstdint>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "progress.hpp"
+#include "wrap.hpp"
+
+int main() {
+    constexpr int32_t iterations = 100'000'000;
+    bench::NullBuffer null_buffer;
+    std::ostream null_stream(&null_buffer);
+
+    double bare = bench::ns_per_iteration(iterations, [&] {
+        for (int32_t i = 0; i < iterations; i++) {
+            bench::do_not_optimize(i);
+        }
+    });
+    std::cout << "bare loop       : " << bare << " ns/iteration\n";
+
+    for (int32_t ticks : {1, 100, 10'000}) {
+        double bar = bench::ns_per_iteration(iterations, [&] {
+            // the terminal render path, not the log lines a non-terminal ostream gets
+            for (progress::Progress bar(iterations, ticks, null_stream);
+                 int32_t i : bar.output(progress::Output::terminal)) {
+                bench::do_not_optimize(i);
+            }
+        });
+        std::cout << "ticks(" << ticks << ")" << std::string(9 - std::to_string(ticks).size(), ' ')
+                  << ": " << bar << " ns/iteration, overhead " << bar - bare << " ns\n";
+    }
+
+    // the latency histogram, sampled every k increments
+    for (int64_t every : {1, 64}) {
+        double bar = bench::ns_per_iteration(iterations, [&] {
+            progress::Progress bar(iterations, 100, null_stream);
+            bar.output(progress::Output::terminal).instrument(every);
+            for (int32_t i : bar) {
+                bench::do_not_optimize(i);
+            }
+        });
+        std::string label = "instrument(" + std::to_string(every) + ")";
+        std::cout << label << std::string(16 - label.size(), ' ') << ": " << bar
+                  << " ns/iteration, overhead " << bar - bare << " ns\n";
+    }
+
+    // the same over a container, with progress::wrap
+    std::vector<int32_t> values(iterations / 10, 1);
+    auto elements = static_cast<int64_t>(values.size());
+    double bare_range = bench::ns_per_iteration(elements, [&] {
+        for (int32_t &value : values) {
+            bench::do_not_optimize(value);
+        }
+    });
+    double wrapped = bench::ns_per_iteration(elements, [&] {
+        auto view = progress::wrap(values, "wrap", null_stream);
+        view.bar().output(progress::Output::terminal).ticks(100);
+        for (int32_t &value : view) {
+            bench::do_not_optimize(value);
+        }
+    });
+    std::cout << "bare range      : " << bare_range << " ns/iteration\n";
+    std::cout << "wrap, ticks(100): " << wrapped << " ns/iteration, overhead "
+              << wrapped - bare_range << " ns\n";
+    return 0;
+}
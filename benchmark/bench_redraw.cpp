@@ -0,0 +1,56 @@
+/* bytes a bar sends to the terminal over a whole loop, full line redraws against differential() */
+
+#include <cstdint>
+#include <iostream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#include "common.hpp"
+#include "progress.hpp"
+
+namespace {
+
+// counts what would have gone to the terminal
+class CountingBuffer : public std::streambuf {
+public:
+    int64_t bytes{0};
+    int64_t writes{0};
+
+protected:
+    int overflow(int c) override {
+        bytes++;
+        return c;
+    }
+    std::streamsize xsputn(const char *, std::streamsize n) override {
+        bytes += n;
+        writes++;
+        return n;
+    }
+};
+
+}  // namespace
+
+int main() {
+    constexpr int64_t iterations = 10'000'000;
+    for (int64_t ticks : {100, 1000, 10'000, 100'000}) {
+        for (bool differential : {false, true}) {
+            CountingBuffer counting;
+            std::ostream stream(&counting);
+            {
+                progress::Progress bar(iterations, ticks, stream);
+                bar.output(progress::Output::terminal).differential(differential);
+                for (int64_t i : bar) {
+                    bench::do_not_optimize(i);
+                }
+            }
+            std::string label = "ticks(" + std::to_string(ticks) + ")";
+            std::cout << label << std::string(14 - label.size(), ' ')
+                      << (differential ? "differential: " : "full line   : ") << counting.bytes
+                      << " bytes in " << counting.writes << " writes, "
+                      << static_cast<double>(counting.bytes) / static_cast<double>(ticks)
+                      << " bytes/tick\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+/* StaticProgress against a bare for loop. With progress::null the loops should be the same */
+
+#include <cstdint>
+#include <iostream>
+#include <ostream>
+
+#include "common.hpp"
+#include "static.hpp"
+
+namespace {
+constexpr progress::Config counter_only{
+    .bar_length = 0, .show_percent = false, .show_elapsed = false, .show_eta = false};
+}
+
+int main() {
+    constexpr int64_t iterations = 100'000'000;
+    bench::NullBuffer null_buffer;
+    std::ostream null_stream(&null_buffer);
+
+    double bare = bench::ns_per_iteration(iterations, [&] {
+        for (int64_t i = 0; i < iterations; i++) {
+            bench::do_not_optimize(i);
+        }
+    });
+    double null = bench::ns_per_iteration(iterations, [&] {
+        for (progress::StaticProgress<progress::null> bar(iterations, null_stream);
+             int64_t i : bar) {
+            bench::do_not_optimize(i);
+        }
+    });
+    double counter = bench::ns_per_iteration(iterations, [&] {
+        for (progress::StaticProgress<counter_only> bar(iterations, null_stream); int64_t i : bar) {
+            bench::do_not_optimize(i);
+        }
+    });
+    double full = bench::ns_per_iteration(iterations, [&] {
+        for (progress::StaticProgress<> bar(iterations, null_stream); int64_t i : bar) {
+            bench::do_not_optimize(i);
+        }
+    });
+    std::cout << "bare loop       : " << bare << " ns/iteration\n";
+    std::cout << "null            : " << null << " ns/iteration, overhead " << null - bare
+              << " ns\n";
+    std::cout << "counter only    : " << counter << " ns/iteration, overhead " << counter - bare
+              << " ns\n";
+    std::cout << "default config  : " << full << " ns/iteration, overhead " << full - bare
+              << " ns\n";
+    return 0;
+}
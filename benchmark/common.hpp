@@ -0,0 +1,35 @@
+// bits shared by the benchmarks
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+
+namespace bench {
+
+// swallows everything, so we only measure the bar and not the terminal
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+// keep the compiler from throwing the loop body away
+template <typename T>
+inline void do_not_optimize(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// runs fn once to warm up, then once more timed
+template <typename Fn>
+double ns_per_iteration(int64_t iterations, Fn &&fn) {
+    fn();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(finish - start).count() /
+           static_cast<double>(iterations);
+}
+
+}  // namespace bench
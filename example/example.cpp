@@ -4,6 +4,7 @@
 #include <iostream>
 #include <thread>
 
+#include "multi.hpp"
 #include "progress.hpp"
 
 int main() {
@@ -25,5 +26,29 @@ int main() {
          bar.name("numbers?").length(50).ticks(1000).style("|= |").update(5).show_bar(false)) {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
+
+    // print at most 10 times a second, however fast the loop goes
+    for (progress::Progress bar(1000);
+         [[maybe_unused]] int cycle : bar.name("such fps").max_fps(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // printing happens on a separate thread, the loop only bumps the counter
+    for (progress::Progress bar(1000);
+         [[maybe_unused]] int cycle : bar.name("so async").async()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // nested bars, drawn together. the inner bar reuses its row on every outer iteration
+    progress::MultiProgress bars;
+    for (progress::Progress outer(5);
+         [[maybe_unused]] int cycle : outer.name("outer").group(bars)) {
+        progress::Progress inner(100);
+        inner.name("inner").group(bars);
+        for (int i = 0; i < 100; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            inner.push();
+        }
+    }
     return 0;
 }
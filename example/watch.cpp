@@ -0,0 +1,115 @@
+// Shows the bars another process publishes to a progress::SharedExport.
+//
+//     $ progress_watch /dev/shm/progress.1234
+//
+// Waits for the file to show up, redraws all the bars every 200ms and exits once the writer is
+// gone.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "multi.hpp"
+#include "shm.hpp"
+
+namespace {
+
+constexpr int bar_length = 20;
+
+// the same columns as a Progress line, with the rate from the start to the last update
+std::string_view compose(std::string &line, const progress::SharedBar &bar,
+                         std::chrono::system_clock::time_point now) {
+    using namespace progress;
+    line.resize(bar.name.size() + bar_length + 3 * detail::max_int_chars +
+                2 * detail::max_duration_chars + 64);
+    char *out = line.data();
+    out = detail::append(out, ' ');
+    out = detail::append(out, bar.name);
+    out = detail::append(out, " : ");
+    if (bar.total != unknown_total) {
+        auto done = static_cast<std::size_t>(std::clamp<int64_t>(
+            detail::muldiv(bar.count, bar_length, std::max<int64_t>(bar.total, 1)), 0, bar_length));
+        out = detail::append(out, '[');
+        std::memset(out, '#', done);
+        std::memset(out + done, ' ', bar_length - done);
+        out += bar_length;
+        out = detail::append(out, "] ");
+    }
+    out = detail::append(out, bar.count);
+    if (bar.total != unknown_total) {
+        out = detail::append(out, " / ");
+        out = detail::append(out, bar.total);
+        out = detail::append(out, ' ');
+        out = detail::append(out, detail::muldiv(bar.count, 100, std::max<int64_t>(bar.total, 1)),
+                             4);
+        out = detail::append(out, '%');
+    }
+
+    auto end = bar.done ? bar.update : now;
+    auto elapsed = end - bar.start;
+    double seconds = std::chrono::duration<double>(bar.update - bar.start).count();
+    if (seconds > 0) {
+        out = detail::append(out, ' ');
+        out = format::count(out, static_cast<int64_t>(static_cast<double>(bar.count) / seconds));
+        out = detail::append(out, "/s");
+    }
+    out = detail::append(out, " Elapsed: ");
+    out = detail::append(out, elapsed);
+    if (bar.done) {
+        out = detail::append(out, " done");
+    } else if (bar.total != unknown_total && bar.count > 0) {
+        out = detail::append(out, " ET: ");
+        out = detail::append(out, std::chrono::system_clock::duration(detail::muldiv(
+                                      elapsed.count(), bar.total, bar.count)));
+    }
+    return {line.data(), static_cast<std::size_t>(out - line.data())};
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <path of the progress::SharedExport>" << std::endl;
+        return 2;
+    }
+
+    std::unique_ptr<progress::SharedReader> reader;
+    while (!reader) {
+        try {
+            reader = std::make_unique<progress::SharedReader>(argv[1]);
+        } catch (const std::exception &) {
+            // not there (yet), or not filled in yet
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+    }
+
+    progress::MultiProgress multi;
+    std::vector<std::size_t> rows;
+    std::vector<progress::SharedBar> bars;
+    std::string line;
+    bool closed = false;
+    while (!closed) {
+        // read closed first, so the last round sees everything the writer did
+        closed = reader->closed();
+        reader->read(bars);
+        while (rows.size() < bars.size()) {
+            rows.push_back(multi.attach());
+        }
+        auto now = std::chrono::system_clock::now();
+        for (std::size_t i = 0; i < bars.size(); i++) {
+            multi.line(rows[i], compose(line, bars[i], now));
+        }
+        // all the bars of this round in one redraw, not just the first
+        multi.refresh();
+        if (!closed) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+    }
+    return 0;
+}
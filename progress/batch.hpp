@@ -0,0 +1,241 @@
+// One bar over a batch of tasks, advanced as each of them finishes.
+//
+//     progress::Batch batch;
+//     std::vector<std::future<Image>> images;
+//     for (auto &path : paths) {
+//         images.push_back(batch.launch([&path] { return load(path); }));
+//     }
+//     for (Image &image : batch.get(images)) { ... }
+//
+// A std::future can't tell anyone it's ready, so the batch launches the tasks itself, through
+// std::async on a thread per task, and every task counts itself done on the way out. Awaitables
+// are started with start(), in a coroutine that does the same once the awaitable resumes it. The
+// waiting thread sleeps on the one condition variable of the batch and moves the bar by however
+// many finished, in the order they finish, not the order they were launched.
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace progress {
+
+namespace detail {
+/**
+ * @brief A coroutine that starts right away and cleans up after itself. Nobody waits for it, it
+ * reports through a promise.
+ */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// what co_await on an A gives, through its operator co_await if it has one
+template <typename A>
+decltype(auto) awaiter_of(A &&awaitable) {
+    if constexpr (requires { std::forward<A>(awaitable).operator co_await(); }) {
+        return std::forward<A>(awaitable).operator co_await();
+    } else if constexpr (requires { operator co_await(std::forward<A>(awaitable)); }) {
+        return operator co_await(std::forward<A>(awaitable));
+    } else {
+        return std::forward<A>(awaitable);
+    }
+}
+
+template <typename A>
+using await_result_t =
+    std::decay_t<decltype(awaiter_of(std::declval<A>()).await_resume())>;
+}  // namespace detail
+
+class Batch {
+public:
+    /**
+     * @brief Construct a new Batch object. The total of the bar grows with every task.
+     *
+     * @param ostream std::ostream object to write to
+     */
+    explicit Batch(std::ostream &ostream = std::cout) : m_bar(0, ostream) {}
+
+    /**
+     * @brief Destroy the Batch object. Waits for the tasks still running, they count into it.
+     */
+    ~Batch() { wait(); }
+
+    Batch(Batch const &) = delete;
+    Batch &operator=(Batch const &) = delete;
+    Batch(Batch &&) = delete;
+    Batch &operator=(Batch &&) = delete;
+
+    /**
+     * @brief Run fn() with std::async on a thread of its own, always std::launch::async: a
+     * deferred task would never run, nobody calls get() on the future of std::async.
+     *
+     * There's no pool and no bound, every launch() starts an OS thread right away, and all of
+     * them run at once. Fine for tens of tasks that mostly wait, like I/O. For thousands, or for
+     * work that keeps the cores busy, run them on a pool of your own and start() what it hands
+     * back, or use parallel_for() of parallel.hpp.
+     *
+     * @param fn the task
+     * @return std::future of what fn returns
+     */
+    template <typename Fn>
+    auto launch(Fn &&fn) -> std::future<std::invoke_result_t<Fn>>;
+
+    /**
+     * @brief Start awaiting awaitable, e.g. a coroutine task. It runs until it suspends the first
+     * time, then finishes on whatever thread resumes it.
+     *
+     * @param awaitable anything that can be co_awaited, taken over by the batch
+     * @return std::future of what co_await gives
+     */
+    template <typename Awaitable>
+    auto start(Awaitable awaitable) -> std::future<detail::await_result_t<Awaitable>>;
+
+    /**
+     * @brief Wait until every task launched so far is done, moving the bar as they finish. From
+     * the thread that launches the tasks.
+     */
+    void wait();
+
+    /**
+     * @brief wait(), then the results, in the order of futures. Rethrows the first exception.
+     *
+     * @param futures the futures of launch() or start()
+     * @return std::vector<T> the results
+     */
+    template <typename T>
+    std::vector<T> get(std::vector<std::future<T>> &futures);
+
+    /**
+     * @brief The bar, for the named parameters like name() or length().
+     *
+     * @return Progress&
+     */
+    Progress &bar() { return m_bar; }
+
+private:
+    template <typename Awaitable, typename T>
+    static detail::Detached drive(Awaitable awaitable, std::promise<T> promise, Batch &batch);
+
+    // one more task to wait for
+    void begin();
+
+    // a task is done, from the thread it finished on
+    void finish();
+
+    std::mutex m_mutex;
+    std::condition_variable m_finished;
+    int64_t m_started{0};
+    int64_t m_done{0};
+    std::vector<std::future<void>> m_running;
+    Progress m_bar;
+};
+
+template <typename Fn>
+auto Batch::launch(Fn &&fn) -> std::future<std::invoke_result_t<Fn>> {
+    begin();
+    // finish() once the result is in, so the future is ready by the time wait() returns
+    using T = std::invoke_result_t<Fn>;
+    std::promise<T> promise;
+    std::future<T> future = promise.get_future();
+    auto task = [this, fn = std::forward<Fn>(fn), promise = std::move(promise)]() mutable {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                fn();
+                promise.set_value();
+            } else {
+                promise.set_value(fn());
+            }
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        finish();
+    };
+    // the future of std::async blocks in its destructor, it's kept until the batch is done
+    m_running.push_back(std::async(std::launch::async, std::move(task)));
+    return future;
+}
+
+template <typename Awaitable>
+auto Batch::start(Awaitable awaitable) -> std::future<detail::await_result_t<Awaitable>> {
+    using T = detail::await_result_t<Awaitable>;
+    begin();
+    std::promise<T> promise;
+    std::future<T> future = promise.get_future();
+    drive(std::move(awaitable), std::move(promise), *this);
+    return future;
+}
+
+template <typename Awaitable, typename T>
+detail::Detached Batch::drive(Awaitable awaitable, std::promise<T> promise, Batch &batch) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(awaitable);
+            promise.set_value();
+        } else {
+            promise.set_value(co_await std::move(awaitable));
+        }
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    batch.finish();
+}
+
+template <typename T>
+std::vector<T> Batch::get(std::vector<std::future<T>> &futures) {
+    wait();
+    std::vector<T> results;
+    results.reserve(futures.size());
+    for (auto &future : futures) {
+        results.push_back(future.get());
+    }
+    return results;
+}
+
+inline void Batch::begin() {
+    std::lock_guard lock(m_mutex);
+    m_started++;
+    m_bar.total(m_started);
+}
+
+inline void Batch::finish() {
+    // notify under the lock: once wait() sees the last m_done it may return and the batch be
+    // destroyed, the condition variable with it
+    std::lock_guard lock(m_mutex);
+    m_done++;
+    m_finished.notify_one();
+}
+
+inline void Batch::wait() {
+    std::unique_lock lock(m_mutex);
+    int64_t seen = m_bar.count();
+    while (seen < m_started) {
+        m_finished.wait(lock, [&] { return m_done > seen; });
+        int64_t done = m_done;
+        // draw without the lock, the tasks shouldn't wait on the terminal
+        lock.unlock();
+        m_bar.add(done - seen);
+        seen = done;
+        lock.lock();
+    }
+    lock.unlock();
+    // all done, only the threads of std::async may still be on their way out
+    m_running.clear();
+}
+}  // namespace progress
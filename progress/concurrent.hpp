@@ -0,0 +1,203 @@
+// A Progress that can be advanced from many threads at once.
+//
+// Every thread counts into its own cache line sized slot, so the threads don't fight over the
+// counter. A slot only ever has one thread, so it doesn't even need an atomic add, a relaxed load
+// and store does. Threads that come after the slots ran out all share one extra slot, with a real
+// atomic add. Once in a while a thread tries to take the print lock, sums up the slots and prints.
+// If another thread holds the lock it just carries on, that one is printing anyway.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+#include "progress.hpp"
+
+namespace progress {
+
+namespace detail {
+// not std::hardware_destructive_interference_size, gcc warns that it isn't abi stable
+inline constexpr std::size_t cache_line_size = 64;
+
+// every ConcurrentProgress gets a unique id, so a thread can tell whether its cached slot still
+// belongs to the bar it's adding to
+inline std::atomic<uint64_t> next_bar_id{1};
+
+// the slot the calling thread last used, and for which bar
+struct SlotCache {
+    uint64_t bar{0};
+    void *slot{nullptr};
+    bool exclusive{false};
+};
+inline thread_local SlotCache slot_cache;
+}  // namespace detail
+
+class ConcurrentProgress {
+public:
+    /**
+     * @brief Construct a new ConcurrentProgress object. Prints 1000 ticks, not total, since
+     * every print is a point where the threads have to sync up.
+     *
+     * @param total Number of increments
+     * @param ostream std::ostream object to write to
+     */
+    explicit ConcurrentProgress(int64_t total, std::ostream &ostream = std::cout)
+        : ConcurrentProgress(total, std::min<int64_t>(total, 1000), ostream) {}
+
+    /**
+     * @brief Construct a new ConcurrentProgress object
+     *
+     * @param total Number of increments
+     * @param ticks total number of times the progress bar will be printed
+     * @param ostream std::ostream object to write to
+     */
+    ConcurrentProgress(int64_t total, int64_t ticks, std::ostream &ostream = std::cout);
+
+    /**
+     * @brief Destroy the ConcurrentProgress object. Prints the final count before the bar goes.
+     *
+     * All the threads calling add() should be done by now.
+     */
+    ~ConcurrentProgress() { m_bar.set(count()); }
+
+    ConcurrentProgress(ConcurrentProgress const &) = delete;
+    ConcurrentProgress &operator=(ConcurrentProgress const &) = delete;
+    ConcurrentProgress(ConcurrentProgress &&) = delete;
+    ConcurrentProgress &operator=(ConcurrentProgress &&) = delete;
+
+    /**
+     * @brief Add to the counter. Safe to call from any thread.
+     *
+     * Only touches the calling thread's slot, except every now and then when it's time to try and
+     * print. The first add() from a thread claims a slot. If a thread keeps switching between
+     * bars it claims a new slot every time. Once they run out the threads share the one extra
+     * slot, which is slower but never loses a count.
+     *
+     * @param n how much to add
+     */
+    void add(int64_t n = 1) {
+        detail::SlotCache &cache = detail::slot_cache;
+        if (cache.bar != m_id) [[unlikely]] {
+            claim(cache);
+        }
+        Slot &slot = *static_cast<Slot *>(cache.slot);
+        int64_t value;
+        if (cache.exclusive) [[likely]] {
+            value = slot.count.load(std::memory_order_relaxed) + n;
+            slot.count.store(value, std::memory_order_relaxed);
+        } else {
+            value = slot.count.fetch_add(n, std::memory_order_relaxed) + n;
+        }
+        if (value < slot.next_check.load(std::memory_order_relaxed)) [[likely]] {
+            return;
+        }
+        flush(slot, value);
+    }
+
+    /**
+     * @brief sum of all the slots. Not a snapshot, threads might be adding while this reads.
+     *
+     * @return int64_t the current count
+     */
+    int64_t count() const;
+
+    /**
+     * @brief Set the ticks of the bar. See Progress::ticks()
+     *
+     * @param ticks_
+     * @return ConcurrentProgress&
+     */
+    ConcurrentProgress &ticks(int64_t ticks_);
+
+    /**
+     * @brief The bar that does the printing, for the rest of the named parameters like name() or
+     * length(). Don't push() it yourself.
+     *
+     * @return Progress&
+     */
+    Progress &bar() { return m_bar; }
+
+private:
+    struct alignas(detail::cache_line_size) Slot {
+        std::atomic<int64_t> count{0};
+        // slot count at which the owning thread tries to print next
+        std::atomic<int64_t> next_check{0};
+    };
+
+    /**
+     * @brief hand the calling thread the next free slot, or the shared one if there are none left.
+     *
+     * @param cache the calling thread's slot cache
+     */
+    void claim(detail::SlotCache &cache);
+
+    /**
+     * @brief the slow path of add(). Moves the slot's next check along and prints if nobody else
+     * is.
+     *
+     * @param slot the calling thread's slot
+     * @param value the slot count after the add
+     */
+    void flush(Slot &slot, int64_t value);
+
+    int64_t m_total{};
+    // counts per tick. The slots in use split it, so that together they try about once per tick
+    int64_t m_tick_size{1};
+    uint64_t m_id{detail::next_bar_id.fetch_add(1, std::memory_order_relaxed)};
+    // the slots a thread can have to itself. m_slots[m_slot_count] is the shared one
+    std::size_t m_slot_count{};
+    std::atomic<std::size_t> m_claimed{0};
+    std::unique_ptr<Slot[]> m_slots;
+    std::mutex m_print;
+    Progress m_bar;
+};
+
+inline ConcurrentProgress::ConcurrentProgress(int64_t total, int64_t ticks, std::ostream &ostream)
+    : m_total(total), m_bar(total, ticks, ostream) {
+    // a few more slots than cores, for pools that are a bit oversubscribed
+    m_slot_count = std::max<std::size_t>(8, 2 * std::thread::hardware_concurrency());
+    m_slots = std::make_unique<Slot[]>(m_slot_count + 1);
+    this->ticks(ticks);
+}
+
+inline int64_t ConcurrentProgress::count() const {
+    int64_t sum = 0;
+    for (std::size_t i = 0; i <= m_slot_count; i++) {
+        sum += m_slots[i].count.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+inline ConcurrentProgress &ConcurrentProgress::ticks(int64_t ticks_) {
+    m_bar.ticks(ticks_);
+    m_tick_size =
+        ticks_ > 0 ? std::max<int64_t>(1, m_total / ticks_) : std::max<int64_t>(1, m_total);
+    return *this;
+}
+
+inline void ConcurrentProgress::claim(detail::SlotCache &cache) {
+    std::size_t index = m_claimed.fetch_add(1, std::memory_order_relaxed);
+    cache.bar = m_id;
+    // a slot that has an owner is never handed out again, its owner adds without a lock prefix
+    cache.exclusive = index < m_slot_count;
+    cache.slot = &m_slots[cache.exclusive ? index : m_slot_count];
+}
+
+inline void ConcurrentProgress::flush(Slot &slot, int64_t value) {
+    // the threads that claimed a slot, not the capacity. Those past it are all in the shared one
+    std::size_t claimed = m_claimed.load(std::memory_order_relaxed);
+    auto slots = static_cast<int64_t>(std::clamp<std::size_t>(claimed, 1, m_slot_count + 1));
+    int64_t quantum = std::max<int64_t>(1, m_tick_size / slots);
+    slot.next_check.store(value + quantum, std::memory_order_relaxed);
+    std::unique_lock lock(m_print, std::try_to_lock);
+    if (lock.owns_lock()) {
+        m_bar.set(count());
+    }
+}
+}  // namespace progress
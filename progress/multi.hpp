@@ -0,0 +1,233 @@
+// Many bars on the terminal at once, e.g. an outer and an inner loop, or one bar per worker.
+//
+// The bars send their lines to a MultiProgress instead of writing them. It keeps one row per bar
+// and redraws the rows that changed as one block, moving the cursor with ANSI escapes. All the
+// changed rows go out in a single write per refresh, at most one refresh per min_interval(). A
+// thread of its own draws the rows that changed since, when no new line comes to do it.
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace progress {
+
+class MultiProgress : public LineSink {
+public:
+    /**
+     * @brief Construct a new MultiProgress object
+     *
+     * @param ostream std::ostream object to write to. Should be a terminal that understands ANSI
+     * escapes
+     */
+    explicit MultiProgress(std::ostream &ostream = std::cout);
+
+    /**
+     * @brief Destroy the MultiProgress object. Stops the thread, draws whatever is still pending
+     * and leaves the cursor below the block.
+     */
+    ~MultiProgress() override;
+
+    MultiProgress(MultiProgress const &) = delete;
+    MultiProgress &operator=(MultiProgress const &) = delete;
+    MultiProgress(MultiProgress &&) = delete;
+    MultiProgress &operator=(MultiProgress &&) = delete;
+
+    /**
+     * @brief Minimum time between two redraws of the block. Default 100ms. Lines that come in
+     * between are batched into the next redraw, which the thread does once the interval is over.
+     * 0 redraws on every new line from a bar.
+     *
+     * @param interval minimum time between redraws
+     * @return MultiProgress&
+     */
+    template <typename Rep, typename Period>
+    MultiProgress &min_interval(std::chrono::duration<Rep, Period> interval);
+
+    /**
+     * @brief Redraw the rows that changed since the last redraw now.
+     */
+    void refresh();
+
+    /**
+     * @brief a bar starts. It gets the first row that isn't in use by another bar, so the inner bar
+     * of a nested loop keeps reusing the same row.
+     *
+     * @return std::size_t the row
+     */
+    std::size_t attach() override;
+
+    /**
+     * @brief new line for the bar in slot. Redraws if the refresh interval has passed.
+     */
+    void line(std::size_t slot, std::string_view line) override;
+
+    /**
+     * @brief the bar in slot is done. Its last line stays until another bar takes the row.
+     */
+    void detach(std::size_t slot) override;
+
+private:
+    struct Row {
+        std::string text;
+        bool dirty{false};
+        bool live{false};
+    };
+
+    /**
+     * @brief refresh(), with m_mutex already held.
+     */
+    void refresh_locked();
+
+    /**
+     * @brief body of the thread, draws the rows left dirty once min_interval() passed.
+     */
+    void run();
+
+    std::vector<Row> m_rows;
+    // rows that are on the terminal already, the cursor is on the line below them
+    std::size_t m_drawn{0};
+    // reused for every redraw, only grows
+    std::string m_frame;
+    std::chrono::high_resolution_clock::duration m_min_interval{std::chrono::milliseconds(100)};
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_last_refresh;
+    // some row changed since the last redraw
+    bool m_pending{false};
+    bool m_stop{false};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::ostream &m_output;
+    std::thread m_thread;
+};
+
+inline MultiProgress::MultiProgress(std::ostream &ostream) : m_output(ostream) {
+    m_thread = std::thread([this] { run(); });
+}
+
+inline MultiProgress::~MultiProgress() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    std::lock_guard lock(m_mutex);
+    refresh_locked();
+}
+
+template <typename Rep, typename Period>
+MultiProgress &MultiProgress::min_interval(std::chrono::duration<Rep, Period> interval) {
+    std::lock_guard lock(m_mutex);
+    m_min_interval =
+        std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(interval);
+    // the thread may be waiting on the old interval
+    m_wake.notify_one();
+    return *this;
+}
+
+inline void MultiProgress::refresh() {
+    std::lock_guard lock(m_mutex);
+    refresh_locked();
+}
+
+inline std::size_t MultiProgress::attach() {
+    std::lock_guard lock(m_mutex);
+    std::size_t slot = 0;
+    while (slot < m_rows.size() && m_rows[slot].live) {
+        slot++;
+    }
+    if (slot == m_rows.size()) {
+        m_rows.emplace_back();
+    }
+    m_rows[slot].live = true;
+    return slot;
+}
+
+inline void MultiProgress::line(std::size_t slot, std::string_view line) {
+    std::lock_guard lock(m_mutex);
+    // assign keeps the capacity, so a row only allocates while its lines get longer
+    m_rows[slot].text.assign(line);
+    m_rows[slot].dirty = true;
+    m_pending = true;
+    if (std::chrono::high_resolution_clock::now() - m_last_refresh >= m_min_interval) {
+        refresh_locked();
+    }
+}
+
+inline void MultiProgress::detach(std::size_t slot) {
+    std::lock_guard lock(m_mutex);
+    m_rows[slot].live = false;
+    refresh_locked();
+}
+
+inline void MultiProgress::refresh_locked() {
+    m_last_refresh = std::chrono::high_resolution_clock::now();
+    m_pending = false;
+    // "\x1b[<rows>A", then per row "\r<text>\x1b[K\n", or "\n" for the ones that didn't change
+    std::size_t size = 32;
+    bool dirty = m_drawn < m_rows.size();
+    for (const Row &row : m_rows) {
+        dirty = dirty || row.dirty;
+        size += row.text.size() + 5;
+    }
+    if (!dirty) {
+        return;
+    }
+    if (m_frame.size() < size) {
+        m_frame.resize(size);
+    }
+
+    char *out = m_frame.data();
+    if (m_drawn > 0) {
+        // back up to the first row of the block
+        out = detail::append(out, "\x1b[");
+        out = detail::append(out, static_cast<int64_t>(m_drawn));
+        out = detail::append(out, 'A');
+    }
+    for (std::size_t i = 0; i < m_rows.size(); i++) {
+        Row &row = m_rows[i];
+        if (row.dirty || i >= m_drawn) {
+            // draw the row and clear whatever was left of a longer old line
+            out = detail::append(out, '\r');
+            out = detail::append(out, row.text);
+            out = detail::append(out, "\x1b[K");
+            row.dirty = false;
+        }
+        out = detail::append(out, '\n');
+    }
+    m_drawn = m_rows.size();
+    m_output.write(m_frame.data(), out - m_frame.data());
+    m_output.flush();
+}
+
+inline void MultiProgress::run() {
+    std::unique_lock lock(m_mutex);
+    while (!m_stop) {
+        if (m_min_interval.count() <= 0) {
+            // every line redraws by itself, nothing is ever left over
+            m_wake.wait(lock, [this] { return m_stop || m_min_interval.count() > 0; });
+            continue;
+        }
+        if (!m_pending) {
+            m_wake.wait_for(lock, m_min_interval);
+            continue;
+        }
+        auto due = m_last_refresh + m_min_interval;
+        if (std::chrono::high_resolution_clock::now() >= due) {
+            refresh_locked();
+        } else {
+            m_wake.wait_until(lock, due);
+        }
+    }
+}
+}  // namespace progress
@@ -0,0 +1,248 @@
+// A parallel index loop with a bar.
+//
+//     progress::parallel_for(n, [&](int64_t i) { ... });
+//     progress::parallel_for_each(items, [&](auto &item) { ... });
+//
+// The index range is split evenly over the threads up front. Every thread works through its own
+// part a chunk at a time, and a thread that runs out steals the back half of another thread's
+// part. The bar is a ConcurrentProgress that gets one add() per finished chunk, not per index.
+// Once the loop is done every thread's throughput is printed below the bar, and returned.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <ranges>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "concurrent.hpp"
+#include "progress.hpp"
+
+namespace progress {
+
+/**
+ * @brief How parallel_for() runs.
+ */
+struct ParallelConfig {
+    // number of threads, including the calling one. 0 for std::thread::hardware_concurrency()
+    unsigned threads{0};
+    // indices per chunk. 0 for about 64 chunks per thread
+    int64_t chunk{0};
+    // the name of the bar
+    std::string_view name{"Progress"};
+    // print every thread's throughput after the loop
+    bool report{true};
+};
+
+/**
+ * @brief What one thread of a parallel_for() did.
+ */
+struct WorkerStats {
+    int64_t items{0};
+    int64_t chunks{0};
+    // times it took work from another thread
+    int64_t steals{0};
+    // from the start of the loop until the thread ran out of work
+    std::chrono::nanoseconds busy{};
+
+    double per_second() const {
+        double seconds = std::chrono::duration<double>(busy).count();
+        return seconds > 0 ? static_cast<double>(items) / seconds : 0.;
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief The part of the index range that's left for each thread, and the stealing.
+ */
+class StealingRanges {
+public:
+    StealingRanges(int64_t n, std::size_t threads, int64_t chunk)
+        : m_parts(std::make_unique<Part[]>(threads)), m_threads(threads), m_chunk(chunk) {
+        for (std::size_t t = 0; t < threads; t++) {
+            m_parts[t].begin = muldiv(n, static_cast<int64_t>(t), static_cast<int64_t>(threads));
+            m_parts[t].end = muldiv(n, static_cast<int64_t>(t + 1), static_cast<int64_t>(threads));
+        }
+    }
+
+    /**
+     * @brief the next chunk for thread self, from its own part or stolen.
+     *
+     * @return false if there's nothing left anywhere
+     */
+    bool take(std::size_t self, int64_t &begin, int64_t &end, WorkerStats &stats) {
+        if (take_own(self, begin, end)) {
+            return true;
+        }
+        for (std::size_t k = 1; k < m_threads; k++) {
+            Part &victim = m_parts[(self + k) % m_threads];
+            int64_t from;
+            int64_t to;
+            {
+                std::lock_guard lock(victim.mutex);
+                if (victim.begin == victim.end) {
+                    continue;
+                }
+                // the back half, or all of it if that's less than a chunk. The victim keeps
+                // working from the front
+                int64_t left = victim.end - victim.begin;
+                from = left <= m_chunk ? victim.begin : victim.begin + left / 2;
+                to = victim.end;
+                victim.end = from;
+            }
+            stats.steals++;
+            // never hold two locks, two threads stealing from each other would deadlock
+            Part &own = m_parts[self];
+            {
+                std::lock_guard lock(own.mutex);
+                own.begin = from;
+                own.end = to;
+            }
+            if (take_own(self, begin, end)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct alignas(cache_line_size) Part {
+        std::mutex mutex;
+        int64_t begin{0};
+        int64_t end{0};
+    };
+
+    bool take_own(std::size_t self, int64_t &begin, int64_t &end) {
+        Part &own = m_parts[self];
+        std::lock_guard lock(own.mutex);
+        if (own.begin == own.end) {
+            return false;
+        }
+        begin = own.begin;
+        end = std::min(own.end, own.begin + m_chunk);
+        own.begin = end;
+        return true;
+    }
+
+    std::unique_ptr<Part[]> m_parts;
+    std::size_t m_threads;
+    int64_t m_chunk;
+};
+
+inline void report(std::ostream &ostream, const std::vector<WorkerStats> &stats) {
+    char rate[format::max_chars];
+    for (std::size_t t = 0; t < stats.size(); t++) {
+        char *end = format::count(rate, static_cast<int64_t>(stats[t].per_second()));
+        ostream << " thread " << t << " : " << stats[t].items << " in " << stats[t].chunks
+                << " chunks, " << stats[t].steals << " stolen, "
+                << std::string_view(rate, static_cast<std::size_t>(end - rate)) << "/s\n";
+    }
+    ostream.flush();
+}
+}  // namespace detail
+
+/**
+ * @brief fn(i) for every i in [0, n), on config.threads threads, with a bar.
+ *
+ * If fn throws, the other threads stop after their current chunk and the first exception is
+ * rethrown here.
+ *
+ * @param n number of indices
+ * @param fn the loop body, called concurrently
+ * @param config threads, chunk size and so on
+ * @param ostream std::ostream object to write to
+ * @return std::vector<WorkerStats> what every thread did, the calling thread first
+ */
+template <typename Fn>
+std::vector<WorkerStats> parallel_for(int64_t n, Fn &&fn, ParallelConfig config = {},
+                                      std::ostream &ostream = std::cout) {
+    std::size_t threads = config.threads > 0 ? config.threads : std::thread::hardware_concurrency();
+    threads = std::max<std::size_t>(threads, 1);
+    int64_t chunk =
+        config.chunk > 0 ? config.chunk
+                         : std::max<int64_t>(1, n / (64 * static_cast<int64_t>(threads)));
+
+    std::vector<WorkerStats> stats(threads);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::atomic<bool> stop{false};
+    {
+        ConcurrentProgress bar(n, ostream);
+        bar.bar().name(config.name);
+        detail::StealingRanges ranges(n, threads, chunk);
+        auto start = std::chrono::steady_clock::now();
+
+        auto work = [&](std::size_t self) {
+            WorkerStats &own = stats[self];
+            int64_t begin;
+            int64_t end;
+            try {
+                while (!stop.load(std::memory_order_relaxed) &&
+                       ranges.take(self, begin, end, own)) {
+                    for (int64_t i = begin; i < end; i++) {
+                        fn(i);
+                    }
+                    bar.add(end - begin);
+                    own.items += end - begin;
+                    own.chunks++;
+                }
+            } catch (...) {
+                std::lock_guard lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                stop.store(true, std::memory_order_relaxed);
+            }
+            own.busy = std::chrono::steady_clock::now() - start;
+        };
+
+        std::vector<std::thread> pool;
+        for (std::size_t t = 1; t < threads; t++) {
+            pool.emplace_back(work, t);
+        }
+        work(0);
+        for (auto &thread : pool) {
+            thread.join();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (config.report) {
+        detail::report(ostream, stats);
+    }
+    return stats;
+}
+
+/**
+ * @brief fn(element) for every element of range, see parallel_for().
+ *
+ * @param range a sized random access range, e.g. a vector
+ * @param fn the loop body, called concurrently
+ * @param config threads, chunk size and so on
+ * @param ostream std::ostream object to write to
+ * @return std::vector<WorkerStats> what every thread did, the calling thread first
+ */
+template <std::ranges::random_access_range R, typename Fn>
+    requires std::ranges::sized_range<R>
+std::vector<WorkerStats> parallel_for_each(R &&range, Fn &&fn, ParallelConfig config = {},
+                                           std::ostream &ostream = std::cout) {
+    auto first = std::ranges::begin(range);
+    return parallel_for(
+        static_cast<int64_t>(std::ranges::size(range)),
+        [&](int64_t i) { fn(first[static_cast<std::ranges::range_difference_t<R>>(i)]); }, config,
+        ostream);
+}
+}  // namespace progress
@@ -0,0 +1,187 @@
+// One bar over a pipeline of stages that each have a bar of their own.
+//
+//     progress::ParentProgress pipeline;
+//     pipeline.name("pipeline").child("load", 1).child("transform", 3).child("write", 1);
+//     {
+//         progress::Progress load(files.size());
+//         load.name("load").ticks(100).publish(pipeline);
+//         for (auto i : load) { ... }
+//     }
+//     ...
+//
+// The stages are weighted slots, so the parent knows the whole pipeline up front and has one
+// ETA over all of it. A stage is a normal Progress publishing to the parent, and prints nothing.
+// Its loop costs what it always did between ticks, which are 1000 at most unless ticks() says
+// otherwise. On a tick the parent takes its lock, moves its count by what the stage's share
+// changed and draws the one line if that's a tick of its own.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace progress {
+
+namespace detail {
+// counts of the parent bar per unit of weight
+inline constexpr int64_t weight_scale = 1000;
+
+// the parent count as weight units with one decimal, e.g. 2.4
+inline char *weight_units(char *out, int64_t value) {
+    int64_t tenths = value / (weight_scale / 10);
+    out = append(out, tenths / 10);
+    out = append(out, '.');
+    return append(out, tenths % 10);
+}
+}  // namespace detail
+
+class ParentProgress : public CountSink {
+public:
+    /**
+     * @brief Construct a new ParentProgress object, without any stages yet.
+     *
+     * @param ostream std::ostream object to write to
+     */
+    explicit ParentProgress(std::ostream &ostream = std::cout);
+
+    /**
+     * @brief Add a slot for a stage. Stages publishing to the parent take the slot with their
+     * name, or the next one nobody took yet.
+     *
+     * @param name the name() of the stage's bar
+     * @param weight its share of the whole, e.g. 3 for a stage that takes three times as long
+     * @return ParentProgress&
+     */
+    ParentProgress &child(std::string_view name, int64_t weight = 1);
+
+    /**
+     * @brief the name of the parent bar. The running stage is shown after it.
+     *
+     * @param name string. whatever you want.
+     * @return ParentProgress&
+     */
+    ParentProgress &name(std::string_view name);
+
+    /**
+     * @brief The parent bar, for the other named parameters like length() or style().
+     *
+     * @return Progress&
+     */
+    Progress &bar() { return m_bar; }
+
+    /**
+     * @brief claims the slot of the stage, or adds one of weight 1 if there's none left.
+     */
+    std::size_t attach(std::string_view name, int64_t total) override;
+
+    void count(std::size_t slot, int64_t counter) override;
+
+    /**
+     * @brief the stage is done, all of its weight counts from now on.
+     */
+    void detach(std::size_t slot, int64_t counter) override;
+
+private:
+    struct Slot {
+        std::string name;
+        int64_t weight;
+        // of the stage's bar, unknown_total until it attached
+        int64_t total{unknown_total};
+        int64_t counter{0};
+        // what the stage adds to the parent count
+        int64_t share{0};
+        bool attached{false};
+        bool done{false};
+    };
+
+    /**
+     * @brief the parent count with the new share of slot, and the bar updated with it. With
+     * m_mutex held.
+     */
+    void refresh(Slot &slot);
+
+    // stages may run on threads of their own
+    std::mutex m_mutex;
+    std::vector<Slot> m_slots;
+    int64_t m_weights{0};
+    // the sum of the shares
+    int64_t m_count{0};
+    std::string m_name{"Progress"};
+    Progress m_bar;
+};
+
+inline ParentProgress::ParentProgress(std::ostream &ostream) : m_bar(0, ostream) {
+    m_bar.units(detail::weight_units);
+}
+
+inline ParentProgress &ParentProgress::child(std::string_view name, int64_t weight) {
+    std::lock_guard lock(m_mutex);
+    m_slots.push_back({std::string(name), std::max<int64_t>(weight, 1)});
+    m_weights += m_slots.back().weight;
+    m_bar.total(m_weights * detail::weight_scale);
+    return *this;
+}
+
+inline ParentProgress &ParentProgress::name(std::string_view name) {
+    std::lock_guard lock(m_mutex);
+    m_name = name;
+    m_bar.name(m_name);
+    return *this;
+}
+
+inline std::size_t ParentProgress::attach(std::string_view name, int64_t total) {
+    std::lock_guard lock(m_mutex);
+    auto free = [](const Slot &slot) { return !slot.attached; };
+    auto it = std::find_if(m_slots.begin(), m_slots.end(),
+                           [&](const Slot &slot) { return free(slot) && slot.name == name; });
+    if (it == m_slots.end()) {
+        it = std::find_if(m_slots.begin(), m_slots.end(), free);
+    }
+    if (it == m_slots.end()) {
+        m_slots.push_back({std::string(name), 1});
+        m_weights++;
+        m_bar.total(m_weights * detail::weight_scale);
+        it = m_slots.end() - 1;
+    }
+    it->total = total;
+    it->attached = true;
+    m_bar.name(m_name + " (" + std::string(name) + ")");
+    refresh(*it);
+    return static_cast<std::size_t>(it - m_slots.begin());
+}
+
+inline void ParentProgress::count(std::size_t slot, int64_t counter) {
+    std::lock_guard lock(m_mutex);
+    m_slots[slot].counter = counter;
+    refresh(m_slots[slot]);
+}
+
+inline void ParentProgress::detach(std::size_t slot, int64_t counter) {
+    std::lock_guard lock(m_mutex);
+    m_slots[slot].counter = counter;
+    m_slots[slot].done = true;
+    refresh(m_slots[slot]);
+}
+
+inline void ParentProgress::refresh(Slot &slot) {
+    int64_t weight = slot.weight * detail::weight_scale;
+    int64_t share = 0;
+    if (slot.done) {
+        share = weight;
+    } else if (slot.total != unknown_total && slot.total > 0) {
+        share = detail::muldiv(std::clamp<int64_t>(slot.counter, 0, slot.total), weight,
+                               slot.total);
+    }
+    m_count += share - slot.share;
+    slot.share = share;
+    m_bar.set(m_count);
+}
+}  // namespace progress
@@ -0,0 +1,220 @@
+// One bar for work split over forked worker processes.
+//
+//     progress::ProcessProgress bar(total, workers);
+//     for (std::size_t i = 0; i < workers; i++) {
+//         if ((pids[i] = fork()) == 0) {
+//             auto worker = bar.worker(i);
+//             for (...) { worker.add(1); }
+//             _exit(0);
+//         }
+//     }
+//     bar.watch(pids);
+//
+// The counters live in an anonymous shared mapping made before the fork, one cache line per
+// worker, so a worker's add() is a relaxed store into memory only it writes. The parent sums them
+// up and draws the total with a row per worker below it, each with its recent rate, so a straggler
+// stands out. POSIX only.
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "concurrent.hpp"
+#include "multi.hpp"
+#include "progress.hpp"
+
+namespace progress {
+
+class ProcessProgress {
+    struct alignas(detail::cache_line_size) Slot {
+        std::atomic<int64_t> count{0};
+    };
+
+public:
+    /**
+     * @brief What a worker process gets. Cheap to copy, only points into the shared mapping.
+     */
+    class Worker {
+    public:
+        /**
+         * @brief Add to this worker's counter. Only one process may use a worker index.
+         *
+         * @param n how much to add
+         */
+        void add(int64_t n = 1) {
+            m_slot->count.store(m_slot->count.load(std::memory_order_relaxed) + n,
+                                std::memory_order_relaxed);
+        }
+
+    private:
+        friend class ProcessProgress;
+        explicit Worker(Slot *slot) : m_slot(slot) {}
+
+        Slot *m_slot;
+    };
+
+    /**
+     * @brief Construct a new ProcessProgress object. Do this before forking the workers.
+     *
+     * @param total Number of increments over all the workers
+     * @param workers number of worker processes
+     * @param ostream std::ostream object to write to. Should be a terminal that understands ANSI
+     * escapes
+     */
+    ProcessProgress(int64_t total, std::size_t workers, std::ostream &ostream = std::cout);
+
+    /**
+     * @brief Destroy the ProcessProgress object. In the parent, draws the final counts. In a
+     * worker that didn't _exit() it does nothing, the bars belong to the parent.
+     */
+    ~ProcessProgress();
+
+    ProcessProgress(ProcessProgress const &) = delete;
+    ProcessProgress &operator=(ProcessProgress const &) = delete;
+    ProcessProgress(ProcessProgress &&) = delete;
+    ProcessProgress &operator=(ProcessProgress &&) = delete;
+
+    /**
+     * @brief the handle for worker index, to use in the forked process.
+     *
+     * @param index 0 to workers - 1
+     * @return Worker
+     */
+    Worker worker(std::size_t index) { return Worker(&m_slots[index]); }
+
+    /**
+     * @brief sum of all the workers' counters.
+     *
+     * @return int64_t the current count
+     */
+    int64_t count() const;
+
+    /**
+     * @brief Read the counters and redraw. For a loop of your own, watch() does it for you.
+     */
+    void refresh();
+
+    /**
+     * @brief Redraw every refresh until all the processes in pids have exited. Reaps them.
+     *
+     * @param pids the worker processes
+     * @param refresh time between redraws
+     */
+    void watch(const std::vector<pid_t> &pids,
+               std::chrono::milliseconds refresh = std::chrono::milliseconds(100));
+
+    /**
+     * @brief The bar of the total, for the named parameters like name() or length().
+     *
+     * @return Progress&
+     */
+    Progress &bar() { return *m_bar; }
+
+private:
+    std::size_t m_workers;
+    Slot *m_slots{nullptr};
+    // the process that made the mapping, the only one that draws
+    pid_t m_owner{::getpid()};
+    std::unique_ptr<MultiProgress> m_multi;
+    std::unique_ptr<Progress> m_bar;
+    std::vector<std::unique_ptr<Progress>> m_worker_bars;
+};
+
+inline ProcessProgress::ProcessProgress(int64_t total, std::size_t workers, std::ostream &ostream)
+    : m_workers(workers), m_multi(std::make_unique<MultiProgress>(ostream)) {
+    void *mapping = ::mmap(nullptr, m_workers * sizeof(Slot), PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "progress: mmap");
+    }
+    m_slots = static_cast<Slot *>(mapping);
+    for (std::size_t i = 0; i < m_workers; i++) {
+        new (&m_slots[i]) Slot{};
+    }
+
+    // the block is drawn once per refresh(), not once per bar
+    m_multi->min_interval(std::chrono::hours(24));
+    m_bar = std::make_unique<Progress>(total, ostream);
+    m_bar->group(*m_multi);
+    for (std::size_t i = 0; i < m_workers; i++) {
+        auto bar = std::make_unique<Progress>(unknown_total, ostream);
+        // a short memory, so the rate says how the worker is doing now, not on average
+        bar->name("worker " + std::to_string(i))
+            .show_rate(true)
+            .min_interval(std::chrono::milliseconds(0))
+            .estimator(std::make_unique<EwmaEstimator>(std::chrono::seconds(2)))
+            .group(*m_multi);
+        m_worker_bars.push_back(std::move(bar));
+    }
+}
+
+inline ProcessProgress::~ProcessProgress() {
+    if (::getpid() != m_owner) {
+        // a copy in a forked worker. Its bars would draw, and an async() bar would try to join a
+        // thread that only exists in the parent, so they go down with the process instead
+        for (auto &bar : m_worker_bars) {
+            (void)bar.release();
+        }
+        (void)m_bar.release();
+        (void)m_multi.release();
+        return;
+    }
+    refresh();
+    m_worker_bars.clear();
+    m_bar.reset();
+    m_multi.reset();
+    ::munmap(m_slots, m_workers * sizeof(Slot));
+}
+
+inline int64_t ProcessProgress::count() const {
+    int64_t sum = 0;
+    for (std::size_t i = 0; i < m_workers; i++) {
+        sum += m_slots[i].count.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+inline void ProcessProgress::refresh() {
+    int64_t sum = 0;
+    for (std::size_t i = 0; i < m_workers; i++) {
+        int64_t count = m_slots[i].count.load(std::memory_order_relaxed);
+        m_worker_bars[i]->set(count);
+        sum += count;
+    }
+    m_bar->set(sum);
+    m_multi->refresh();
+}
+
+inline void ProcessProgress::watch(const std::vector<pid_t> &pids,
+                                   std::chrono::milliseconds refresh) {
+    std::size_t running = pids.size();
+    std::vector<bool> exited(pids.size(), false);
+    while (running > 0) {
+        this->refresh();
+        std::this_thread::sleep_for(refresh);
+        for (std::size_t i = 0; i < pids.size(); i++) {
+            if (!exited[i] && ::waitpid(pids[i], nullptr, WNOHANG) != 0) {
+                exited[i] = true;
+                running--;
+            }
+        }
+    }
+    this->refresh();
+}
+}  // namespace progress
@@ -20,23 +20,803 @@
 // Have fun. Don't forget to bookmark http://www.network-science.de/ascii/ :)
 //
 // Any other prints within the loop will break this.
-//
-// TODO: can use the destructor to also output time perf.
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <coroutine>
 #include <cstdint>
-#include <iomanip>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <ostream>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// the time stamp counter clock, x86 with gcc or clang only
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define PROGRESS_HAS_TSC 1
+#else
+#define PROGRESS_HAS_TSC 0
+#endif
+
+#if defined(_MSC_VER)
+#define PROGRESS_NOINLINE __declspec(noinline)
+#else
+#define PROGRESS_NOINLINE __attribute__((noinline))
+#endif
 
 namespace progress {
 
+namespace detail {
+#if defined(__SIZEOF_INT128__)
+// __extension__ so -Wpedantic doesn't warn, __int128 isn't standard
+__extension__ typedef __int128 int128;
+#endif
+
+/**
+ * @brief a * b / c, rounded down, without overflowing in between. Saturates at the largest
+ * int64_t. Counters can get close to 2^63, so counter * ticks doesn't fit in 64 bits.
+ *
+ * @param a,b >= 0
+ * @param c > 0
+ * @return int64_t a * b / c
+ */
+inline int64_t muldiv(int64_t a, int64_t b, int64_t c) {
+#if defined(__SIZEOF_INT128__)
+    int128 result = static_cast<int128>(a) * b / c;
+#else
+    long double result = static_cast<long double>(a) * b / c;
+#endif
+    if (result > std::numeric_limits<int64_t>::max()) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    return static_cast<int64_t>(result);
+}
+
+/**
+ * @brief a * b / c like muldiv(), but rounded up.
+ */
+inline int64_t muldiv_ceil(int64_t a, int64_t b, int64_t c) {
+#if defined(__SIZEOF_INT128__)
+    int128 scaled = static_cast<int128>(a) * b;
+    int128 result = scaled / c + (scaled % c != 0 ? 1 : 0);
+#else
+    long double result = std::ceil(static_cast<long double>(a) * b / c);
+#endif
+    if (result > std::numeric_limits<int64_t>::max()) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    return static_cast<int64_t>(result);
+}
+
+/**
+ * @brief a + b for a, b >= 0, saturating at the largest int64_t.
+ */
+inline int64_t add_saturated(int64_t a, int64_t b) {
+    return a > std::numeric_limits<int64_t>::max() - b ? std::numeric_limits<int64_t>::max()
+                                                       : a + b;
+}
+
+/**
+ * @brief whether os writes to a terminal. Only std::cout, std::cerr and std::clog can be, anything
+ * else (files, string streams) isn't.
+ */
+inline bool is_terminal(const std::ostream &os) {
+#if defined(_WIN32)
+    auto isatty = [](int fd) { return _isatty(fd) != 0; };
+#endif
+    if (os.rdbuf() == std::cout.rdbuf()) {
+        return isatty(1);
+    }
+    if (os.rdbuf() == std::cerr.rdbuf() || os.rdbuf() == std::clog.rdbuf()) {
+        return isatty(2);
+    }
+    return false;
+}
+
+/**
+ * @brief text as the inside of a json string, i.e. with quotes, backslashes and control characters
+ * escaped. Writes at most 6 characters per character of text.
+ */
+inline char *append_json(char *out, std::string_view text) {
+    constexpr char hex[] = "0123456789abcdef";
+    for (char c : text) {
+        auto u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            *out++ = '\\';
+            *out++ = c;
+        } else if (u < 0x20) {
+            std::memcpy(out, "\\u00", 4);
+            out[4] = hex[u >> 4];
+            out[5] = hex[u & 0xf];
+            out += 6;
+        } else {
+            *out++ = c;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief bytes in the utf-8 character starting with lead. A stray continuation byte counts as one.
+ */
+inline std::size_t utf8_length(char lead) {
+    auto c = static_cast<unsigned char>(lead);
+    return c < 0xc0 ? 1 : c < 0xe0 ? 2 : c < 0xf0 ? 3 : 4;
+}
+
+/**
+ * @brief the code point of the utf-8 character at text, which is size bytes long.
+ */
+inline char32_t utf8_decode(const char *text, std::size_t size) {
+    constexpr unsigned char lead_bits[] = {0xff, 0x1f, 0x0f, 0x07};
+    char32_t c = static_cast<unsigned char>(text[0]) & lead_bits[size - 1];
+    for (std::size_t i = 1; i < size; i++) {
+        c = (c << 6) | (static_cast<unsigned char>(text[i]) & 0x3f);
+    }
+    return c;
+}
+
+/**
+ * @brief columns the code point takes on a terminal, like wcwidth() but without the locale. 0 for
+ * controls and combining marks, 2 for the wide east asian ranges and emoji, 1 for the rest.
+ */
+inline int display_width(char32_t c) {
+    struct Range {
+        char32_t first;
+        char32_t last;
+    };
+    constexpr Range zero[] = {{0x0300, 0x036f}, {0x0483, 0x0489}, {0x0591, 0x05bd},
+                              {0x1ab0, 0x1aff}, {0x1dc0, 0x1dff}, {0x200b, 0x200f},
+                              {0x20d0, 0x20ff}, {0xfe00, 0xfe0f}, {0xfe20, 0xfe2f},
+                              {0xe0100, 0xe01ef}};
+    constexpr Range wide[] = {{0x1100, 0x115f},   {0x2e80, 0x303e},   {0x3041, 0x33ff},
+                              {0x3400, 0x4dbf},   {0x4e00, 0x9fff},   {0xa000, 0xa4cf},
+                              {0xac00, 0xd7a3},   {0xf900, 0xfaff},   {0xfe30, 0xfe4f},
+                              {0xff00, 0xff60},   {0xffe0, 0xffe6},   {0x1f300, 0x1f64f},
+                              {0x1f680, 0x1f6ff}, {0x1f7e0, 0x1f7eb}, {0x1f900, 0x1f9ff},
+                              {0x1fa70, 0x1faff}, {0x20000, 0x3fffd}};
+    if (c < 0x20 || (c >= 0x7f && c < 0xa0)) {
+        return 0;
+    }
+    if (c < 0x300) {
+        return 1;
+    }
+    auto in = [c](const auto &ranges) {
+        return std::any_of(std::begin(ranges), std::end(ranges),
+                           [c](Range range) { return c >= range.first && c <= range.last; });
+    };
+    return in(zero) ? 0 : in(wide) ? 2 : 1;
+}
+
+/**
+ * @brief bytes of the terminal cell starting at text: one character and the zero width ones after
+ * it, like combining accents.
+ *
+ * @param width set to the columns the cell takes
+ */
+inline std::size_t cell_size(const char *text, const char *end, int &width) {
+    auto c = static_cast<unsigned char>(*text);
+    if (c < 0x80 && (text + 1 == end || static_cast<unsigned char>(text[1]) < 0x80)) {
+        // ascii followed by ascii, most of every line
+        width = c >= 0x20 && c != 0x7f ? 1 : 0;
+        return 1;
+    }
+    auto size = std::min<std::size_t>(utf8_length(*text), static_cast<std::size_t>(end - text));
+    width = display_width(utf8_decode(text, size));
+    while (text + size < end) {
+        auto next = std::min<std::size_t>(utf8_length(text[size]),
+                                          static_cast<std::size_t>(end - text - size));
+        if (display_width(utf8_decode(text + size, next)) != 0) {
+            break;
+        }
+        size += next;
+    }
+    return size;
+}
+
+/**
+ * @brief columns the utf-8 text takes on a terminal.
+ */
+inline std::size_t display_width(std::string_view text) {
+    std::size_t columns = 0;
+    for (const char *at = text.data(), *end = at + text.size(); at < end;) {
+        int width;
+        at += cell_size(at, end, width);
+        columns += static_cast<std::size_t>(width);
+    }
+    return columns;
+}
+
+// worst case characters needed by the append helpers below
+inline constexpr std::size_t max_int_chars = std::numeric_limits<int64_t>::digits10 + 2;
+inline constexpr std::size_t max_duration_chars = 2 * max_int_chars + 3;
+
+// the helpers write into a buffer that is already big enough, and return the new end.
+inline char *append(char *out, std::string_view text) {
+    std::memcpy(out, text.data(), text.size());
+    return out + text.size();
+}
+
+inline char *append(char *out, char c) {
+    *out = c;
+    return out + 1;
+}
+
+inline char *append(char *out, int64_t value) {
+    return std::to_chars(out, out + max_int_chars, value).ptr;
+}
+
+// right aligned to width, like std::setw
+inline char *append(char *out, int64_t value, std::size_t width) {
+    char digits[max_int_chars];
+    char *end = std::to_chars(digits, digits + max_int_chars, value).ptr;
+    auto length = static_cast<std::size_t>(end - digits);
+    if (length < width) {
+        std::memset(out, ' ', width - length);
+        out += width - length;
+    }
+    return append(out, std::string_view(digits, length));
+}
+
+// as <minutes>m:<seconds>s
+template <typename Rep, typename Period>
+char *append(char *out, std::chrono::duration<Rep, Period> time) {
+    auto mins = std::chrono::duration_cast<std::chrono::minutes>(time);
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(time - mins);
+    out = append(out, static_cast<int64_t>(mins.count()));
+    out = append(out, "m:");
+    out = append(out, static_cast<int64_t>(secs.count()));
+    return append(out, 's');
+}
+
+/**
+ * @brief a latency in nanoseconds as "850ns", "12.3us", "4.56ms" or "1.234s".
+ */
+inline char *append_latency(char *out, int64_t nanoseconds) {
+    if (nanoseconds < 1000) {
+        out = append(out, nanoseconds);
+        return append(out, "ns");
+    }
+    constexpr std::pair<double, std::string_view> units[] = {{1e3, "us"}, {1e6, "ms"}, {1e9, "s"}};
+    std::size_t unit = nanoseconds < 1'000'000 ? 0 : nanoseconds < 1'000'000'000 ? 1 : 2;
+    double value = static_cast<double>(nanoseconds) / units[unit].first;
+    int precision = unit == 2 ? 3 : 1;
+    out = std::to_chars(out, out + max_int_chars, value, std::chars_format::fixed, precision).ptr;
+    return append(out, units[unit].second);
+}
+}  // namespace detail
+
+/**
+ * @brief How counts (counter, total, rate) are written. See Progress::units().
+ */
+namespace format {
+/**
+ * @brief writes value into out and returns the new end. May write at most max_chars characters.
+ */
+using Unit = char *(*)(char *out, int64_t value);
+inline constexpr std::size_t max_chars = 32;
+
+/**
+ * @brief plain number. The default.
+ */
+inline char *count(char *out, int64_t value) { return detail::append(out, value); }
+
+/**
+ * @brief bytes, with binary prefixes and one decimal, e.g. 1.5 GiB
+ */
+inline char *bytes(char *out, int64_t value) {
+    constexpr std::string_view units[] = {"B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB"};
+    std::size_t unit = 0;
+    int64_t scale = 1;
+    while (unit + 1 < std::size(units) && value / scale >= 1024) {
+        scale *= 1024;
+        unit++;
+    }
+    if (unit == 0) {
+        out = detail::append(out, value);
+    } else {
+        // tenths of the unit
+        int64_t tenths = detail::muldiv(value, 10, scale);
+        out = detail::append(out, tenths / 10);
+        out = detail::append(out, '.');
+        out = detail::append(out, tenths % 10);
+    }
+    out = detail::append(out, ' ');
+    return detail::append(out, units[unit]);
+}
+}  // namespace format
+
+/**
+ * @brief a Progress::style() with eighth blocks, so the bar moves by an eighth of a character.
+ */
+inline constexpr std::string_view eighth_blocks = "|█ ▏▎▍▌▋▊▉|";
+
+/**
+ * @brief Where the bar goes and what it looks like there. See Progress::output().
+ */
+enum class Output {
+    // terminal if the ostream is one, log otherwise. The default
+    automatic,
+    // one line, redrawn in place with '\r'
+    terminal,
+    // a line per print, every 10 seconds by default
+    log,
+    // a json object per line, every 10 seconds by default. name, count, total, rate (per second),
+    // elapsed and eta (seconds left). total and eta are null when unknown
+    json,
+};
+
+/**
+ * @brief Where a bar gets the time from. See Progress::clock().
+ */
+using Clock = std::chrono::time_point<std::chrono::high_resolution_clock> (*)();
+
+namespace detail {
+/**
+ * @brief How to turn time stamp counter ticks into high_resolution_clock time, measured once.
+ */
+struct TscCalibration {
+    bool usable{false};
+    uint64_t ticks{0};
+    std::chrono::time_point<std::chrono::high_resolution_clock> time;
+    double ns_per_tick{0};
+};
+
+inline TscCalibration calibrate_tsc() {
+    TscCalibration calibration;
+#if PROGRESS_HAS_TSC
+    // the counter has to tick at the same rate in every power state and on every core, that's
+    // the invariant tsc bit
+    unsigned eax = 0;
+    unsigned ebx = 0;
+    unsigned ecx = 0;
+    unsigned edx = 0;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007 ||
+        __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0 || (edx & (1U << 8)) == 0) {
+        return calibration;
+    }
+    // a steady_clock reading and the counter in the middle of it. The first call of a clock can
+    // be much slower than the rest, so there's one to warm up
+    auto pair = [](std::chrono::steady_clock::time_point &steady) {
+        uint64_t before = __rdtsc();
+        steady = std::chrono::steady_clock::now();
+        uint64_t after = __rdtsc();
+        return before + (after - before) / 2;
+    };
+    std::chrono::steady_clock::time_point steady_start;
+    pair(steady_start);
+    calibration.time = std::chrono::high_resolution_clock::now();
+    calibration.ticks = pair(steady_start);
+    // 10ms against steady_clock, that's within a few ppm
+    std::chrono::steady_clock::time_point steady_end;
+    uint64_t ticks_end;
+    do {
+        ticks_end = pair(steady_end);
+    } while (steady_end - steady_start < std::chrono::milliseconds(10));
+    double ns = std::chrono::duration<double, std::nano>(steady_end - steady_start).count();
+    calibration.ns_per_tick = ns / static_cast<double>(ticks_end - calibration.ticks);
+    calibration.usable = calibration.ns_per_tick > 0;
+#endif
+    return calibration;
+}
+
+inline const TscCalibration &tsc_calibration() {
+    static const TscCalibration calibration = calibrate_tsc();
+    return calibration;
+}
+}  // namespace detail
+
+/**
+ * @brief whether tsc_clock() reads the time stamp counter, i.e. this is x86 with an invariant one.
+ * The first call calibrates, which takes 10ms.
+ */
+inline bool tsc_usable() { return detail::tsc_calibration().usable; }
+
+/**
+ * @brief The default Clock, std::chrono::high_resolution_clock::now().
+ */
+inline std::chrono::time_point<std::chrono::high_resolution_clock> default_clock() {
+    return std::chrono::high_resolution_clock::now();
+}
+
+/**
+ * @brief A Clock that reads the time stamp counter, a few nanoseconds instead of a clock_gettime().
+ * Calibrated against steady_clock on first use, which takes 10ms. Falls back to default_clock()
+ * where tsc_usable() is false.
+ */
+inline std::chrono::time_point<std::chrono::high_resolution_clock> tsc_clock() {
+#if PROGRESS_HAS_TSC
+    const detail::TscCalibration &calibration = detail::tsc_calibration();
+    if (calibration.usable) [[likely]] {
+        auto ticks = static_cast<double>(__rdtsc() - calibration.ticks);
+        std::chrono::duration<double, std::nano> since(ticks * calibration.ns_per_tick);
+        return calibration.time +
+               std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(since);
+    }
+#endif
+    return default_clock();
+}
+
+/**
+ * @brief Pass as total when it isn't known up front, e.g. for an input range you can only go
+ * through once. The bar then shows a spinner, the count, a smoothed rate and the elapsed time, and
+ * prints at most every 100ms unless min_interval() says otherwise. Progress::total() turns it into
+ * a normal bar once the total is known.
+ */
+inline constexpr int64_t unknown_total = -1;
+
+/**
+ * @brief Counts per second, and a band the rate is likely in. low == high means no band.
+ */
+struct Rate {
+    double per_second{};
+    double low{};
+    double high{};
+};
+
+/**
+ * @brief Works out the rate for the rate column and the ET. Set one with Progress::estimator().
+ *
+ * Gets a sample on every print, so sample() and rate() should be O(1) and not allocate.
+ */
+class RateEstimator {
+public:
+    virtual ~RateEstimator() = default;
+
+    /**
+     * @brief a new point of the counter over time
+     *
+     * @param elapsed time since the bar started
+     * @param counter the counter at that time
+     */
+    virtual void sample(std::chrono::high_resolution_clock::duration elapsed, int64_t counter) = 0;
+
+    /**
+     * @brief the rate as of the last sample
+     *
+     * @return Rate
+     */
+    virtual Rate rate() const = 0;
+};
+
+/**
+ * @brief counter / elapsed time. What the bar does without an estimator, so mostly useful as the
+ * baseline. No band.
+ */
+class LinearEstimator : public RateEstimator {
+public:
+    void sample(std::chrono::high_resolution_clock::duration elapsed, int64_t counter) override {
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        if (seconds > 0) {
+            m_rate = static_cast<double>(counter) / seconds;
+        }
+    }
+    Rate rate() const override { return {m_rate, m_rate, m_rate}; }
+
+private:
+    double m_rate{};
+};
+
+/**
+ * @brief Exponentially weighted moving average of the rate between samples. Follows phase
+ * changes, forgets the warm up. The band is two standard deviations of the same weighted average.
+ */
+class EwmaEstimator : public RateEstimator {
+public:
+    /**
+     * @brief Construct a new EwmaEstimator object
+     *
+     * @param half_life after this long a rate has half its weight left. Default 10 seconds
+     */
+    explicit EwmaEstimator(std::chrono::duration<double> half_life = std::chrono::seconds(10))
+        : m_half_life(half_life.count()) {}
+
+    void sample(std::chrono::high_resolution_clock::duration elapsed, int64_t counter) override;
+    Rate rate() const override;
+
+private:
+    double m_half_life;
+    double m_rate{};
+    double m_variance{};
+    // how much of the average the samples so far make up, 1 - 2^(-seconds / half life). Divides
+    // the weights, so the first rates, over a few microseconds, don't stand in for all the time
+    // before them
+    double m_weight{};
+    double m_last_seconds{};
+    int64_t m_last_counter{};
+};
+
+/**
+ * @brief Rate over the last N samples, kept in a ring buffer. The band is two standard deviations
+ * of the rates between neighbouring samples in the window, kept as running sums so a sample is
+ * O(1) no matter N.
+ *
+ * @tparam N number of samples in the window
+ */
+template <std::size_t N = 32>
+class WindowEstimator : public RateEstimator {
+    static_assert(N >= 2, "the window needs at least two samples");
+
+public:
+    void sample(std::chrono::high_resolution_clock::duration elapsed, int64_t counter) override;
+    Rate rate() const override;
+
+private:
+    struct Point {
+        double seconds{};
+        int64_t counter{};
+        // rate between the point before and this one
+        double rate{};
+    };
+
+    std::array<Point, N> m_points{};
+    // index of the oldest point, and how many there are
+    std::size_t m_oldest{0};
+    std::size_t m_size{0};
+    double m_sum{};
+    double m_sum_squares{};
+};
+
+inline void EwmaEstimator::sample(std::chrono::high_resolution_clock::duration elapsed,
+                                  int64_t counter) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double dt = seconds - m_last_seconds;
+    if (dt <= 0) {
+        return;
+    }
+    double instant = static_cast<double>(counter - m_last_counter) / dt;
+    m_last_seconds = seconds;
+    m_last_counter = counter;
+    // the weight of the new rate depends on how long it covers, samples don't come regularly
+    double weight = 1 - std::exp2(-dt / m_half_life);
+    m_weight += weight * (1 - m_weight);
+    double alpha = weight / m_weight;
+    double diff = instant - m_rate;
+    m_rate += alpha * diff;
+    m_variance = (1 - alpha) * (m_variance + alpha * diff * diff);
+}
+
+inline Rate EwmaEstimator::rate() const {
+    double spread = 2 * std::sqrt(m_variance);
+    return {m_rate, std::max(0., m_rate - spread), m_rate + spread};
+}
+
+template <std::size_t N>
+void WindowEstimator<N>::sample(std::chrono::high_resolution_clock::duration elapsed,
+                                int64_t counter) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    Point point{seconds, counter, 0};
+    if (m_size > 0) {
+        const Point &newest = m_points[(m_oldest + m_size - 1) % N];
+        if (seconds <= newest.seconds) {
+            return;
+        }
+        point.rate = static_cast<double>(counter - newest.counter) / (seconds - newest.seconds);
+        m_sum += point.rate;
+        m_sum_squares += point.rate * point.rate;
+    }
+    if (m_size == N) {
+        // the rate between the oldest two points leaves the window with the oldest
+        m_oldest = (m_oldest + 1) % N;
+        m_size--;
+        const Point &gone = m_points[m_oldest];
+        m_sum -= gone.rate;
+        m_sum_squares -= gone.rate * gone.rate;
+    }
+    m_points[(m_oldest + m_size) % N] = point;
+    m_size++;
+}
+
+template <std::size_t N>
+Rate WindowEstimator<N>::rate() const {
+    if (m_size < 2) {
+        return {};
+    }
+    const Point &oldest = m_points[m_oldest];
+    const Point &newest = m_points[(m_oldest + m_size - 1) % N];
+    double rate =
+        static_cast<double>(newest.counter - oldest.counter) / (newest.seconds - oldest.seconds);
+    auto segments = static_cast<double>(m_size - 1);
+    double mean = m_sum / segments;
+    double variance = std::max(0., m_sum_squares / segments - mean * mean);
+    double spread = 2 * std::sqrt(variance);
+    return {rate, std::max(0., rate - spread), rate + spread};
+}
+
+/**
+ * @brief Counts of latencies in nanoseconds, HDR style: exact below 64ns, above that 32 buckets per
+ * power of two, so every value is within about 3%. Fixed size, recording never allocates.
+ */
+class LatencyHistogram {
+public:
+    /**
+     * @brief count values of value nanoseconds.
+     */
+    void record(int64_t value, int64_t count = 1) {
+        value = std::max<int64_t>(value, 0);
+        m_counts[bucket_of(value)] += count;
+        m_count += count;
+        m_max = std::max(m_max, value);
+    }
+
+    /**
+     * @brief number of recorded values.
+     */
+    int64_t count() const { return m_count; }
+
+    /**
+     * @brief largest recorded value, exact.
+     */
+    int64_t max() const { return m_max; }
+
+    /**
+     * @brief the value below or at which quantile of the recorded values are, as the top of its
+     * bucket.
+     *
+     * @param quantile 0 to 1, e.g. 0.99
+     * @return int64_t nanoseconds, 0 if nothing was recorded
+     */
+    int64_t percentile(double quantile) const;
+
+private:
+    static constexpr int sub_bits = 5;
+    static constexpr int64_t linear = int64_t{2} << sub_bits;
+    static constexpr std::size_t buckets = (63 - sub_bits) * (linear / 2) + linear;
+
+    static std::size_t bucket_of(int64_t value) {
+        if (value < linear) {
+            return static_cast<std::size_t>(value);
+        }
+        int shift = std::bit_width(static_cast<uint64_t>(value)) - (sub_bits + 1);
+        return static_cast<std::size_t>(shift * (linear / 2) + (value >> shift));
+    }
+
+    static int64_t highest_of(std::size_t bucket) {
+        auto index = static_cast<int64_t>(bucket);
+        if (index < linear) {
+            return index;
+        }
+        int64_t shift = index / (linear / 2) - 1;
+        int64_t mantissa = index % (linear / 2) + linear / 2;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::array<int64_t, buckets> m_counts{};
+    int64_t m_count{0};
+    int64_t m_max{0};
+};
+
+/**
+ * @brief What an instrument()ed bar measured. See Progress::report().
+ */
+struct PerfReport {
+    // the counter
+    int64_t count{0};
+    // from the construction of the bar until now, or until it was destroyed
+    std::chrono::nanoseconds wall{};
+    // count per second of wall time
+    double per_second{0};
+    // latency of one increment. Sampled every k increments, a sample is the mean of those k
+    std::chrono::nanoseconds p50{};
+    std::chrono::nanoseconds p90{};
+    std::chrono::nanoseconds p99{};
+    std::chrono::nanoseconds max{};
+};
+
+inline int64_t LatencyHistogram::percentile(double quantile) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    auto rank = static_cast<int64_t>(std::ceil(quantile * static_cast<double>(m_count)));
+    rank = std::clamp<int64_t>(rank, 1, m_count);
+    int64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < buckets; bucket++) {
+        seen += m_counts[bucket];
+        if (seen >= rank) {
+            return std::min(highest_of(bucket), m_max);
+        }
+    }
+    return m_max;
+}
+
+/**
+ * @brief Something that takes over printing the lines of one or more bars, instead of each bar
+ * writing to its own ostream. MultiProgress is one. See Progress::group().
+ */
+class LineSink {
+public:
+    virtual ~LineSink() = default;
+
+    /**
+     * @brief a new bar starts sending lines.
+     *
+     * @return std::size_t the slot the bar passes to line() and detach()
+     */
+    virtual std::size_t attach() = 0;
+
+    /**
+     * @brief the newest status line of the bar in slot. Without the trailing '\r'.
+     *
+     * @param slot the slot from attach()
+     * @param line the line, only valid during the call
+     */
+    virtual void line(std::size_t slot, std::string_view line) = 0;
+
+    /**
+     * @brief the bar in slot is done and won't send lines anymore.
+     *
+     * @param slot the slot from attach()
+     */
+    virtual void detach(std::size_t slot) = 0;
+};
+
+/**
+ * @brief Something that takes the raw counts of one or more bars instead of a printed line, e.g. to
+ * show them in another process. SharedExport is one. See Progress::publish().
+ */
+class CountSink {
+public:
+    virtual ~CountSink() = default;
+
+    /**
+     * @brief a new bar starts sending counts.
+     *
+     * @param name the name of the bar
+     * @param total the total of the bar, or unknown_total
+     * @return std::size_t the slot the bar passes to count() and detach()
+     */
+    virtual std::size_t attach(std::string_view name, int64_t total) = 0;
+
+    /**
+     * @brief the counter of the bar in slot reached the next tick.
+     *
+     * @param slot the slot from attach()
+     * @param counter the counter
+     */
+    virtual void count(std::size_t slot, int64_t counter) = 0;
+
+    /**
+     * @brief the bar in slot is done and won't send counts anymore.
+     *
+     * @param slot the slot from attach()
+     * @param counter the final counter
+     */
+    virtual void detach(std::size_t slot, int64_t counter) = 0;
+};
+
+/**
+ * @brief What Progress::add() and step() return, so a coroutine can co_await them. The bar has
+ * moved by then already, it never suspends.
+ */
+struct Step {
+    bool await_ready() const noexcept { return true; }
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+    void await_resume() const noexcept {}
+};
+
 class Progress {
 public:
     struct Iterator {
@@ -46,11 +826,11 @@ public:
          * @param ptr Pointer to the private counter attribute of the Progress object
          * @param bar a reference to the progress bar itself
          */
-        Iterator(int32_t *ptr, Progress &bar) : m_ptr(ptr), m_progress(bar) {}
+        Iterator(int64_t *ptr, Progress &bar) : m_ptr(ptr), m_progress(bar) {}
 
         // necessary operators
-        int32_t &operator*() const { return *m_ptr; }
-        int32_t *operator->() { return m_ptr; }
+        int64_t &operator*() const { return *m_ptr; }
+        int64_t *operator->() { return m_ptr; }
         /**
          * @brief the main operator that does the heavy lifting. calls push() on the progress
          *
@@ -70,7 +850,7 @@ public:
 
     private:
         // should be a pointer to the progress bar counter
-        int32_t *m_ptr{nullptr};
+        int64_t *m_ptr{nullptr};
         Progress &m_progress;
     };
 
@@ -80,7 +860,7 @@ public:
      * @param total Number of increments. max counter value will be total - 1
      * @param ostream std::ostream object to write to
      */
-    explicit Progress(int32_t total, std::ostream &ostream = std::cout);
+    explicit Progress(int64_t total, std::ostream &ostream = std::cout);
 
     /**
      * @brief Construct a new Progress object
@@ -91,15 +871,62 @@ public:
      * performace
      * @param ostream std::ostream object to write to
      */
-    Progress(int32_t total, int32_t ticks, std::ostream &ostream = std::cout);
+    Progress(int64_t total, int64_t ticks, std::ostream &ostream = std::cout);
 
     /**
      * @brief Destroy the Progress object. By default calls keep() to print a new line at the end.
      *
+     * In async() mode this first stops the renderer thread. If the final count wasn't printed yet
+     * (async(), an unknown total), it's printed now. With instrument() the time taken is the
+     * PerfReport, in every output mode: a json object with Output::json, the last line of the row
+     * in a group(), and on the ostream of a publish()ed bar.
      */
     ~Progress() {
-        keep();
-        auto finish = std::chrono::high_resolution_clock::now();
+        m_finish = m_now();
+        if (m_histogram) {
+            sample(m_finish);
+        }
+        if (m_async) {
+            stop_async();
+        }
+        // ticks(0) means a bar that never prints, not even the last count
+        bool silent = m_ticks <= 0 && m_total != unknown_total;
+        if (m_counter > 0 && m_counter != m_printed && !silent) {
+            print(m_counter, tick_of(m_counter), m_now());
+        }
+        if (m_sink != nullptr) {
+            if (m_histogram) {
+                // in place of the bar, the row stays until another bar takes it
+                m_sink->line(m_slot, std::string_view(m_line.data(), compose_report()));
+            }
+            m_sink->detach(m_slot);
+            return;
+        }
+        if (m_count_sink != nullptr) {
+            m_count_sink->detach(m_count_slot, m_counter);
+            if (m_histogram) {
+                print_report();
+            }
+            return;
+        }
+        if (m_output_mode == Output::json) {
+            // the last record already has it all, but for the report
+            if (m_histogram) {
+                std::size_t length = compose_report_json();
+                m_line[length] = '\n';
+                m_output.write(m_line.data(), static_cast<std::streamsize>(length + 1));
+                m_output.flush();
+            }
+            return;
+        }
+        if (m_output_mode == Output::terminal) {
+            keep();
+        }
+        if (m_histogram) {
+            print_report();
+            return;
+        }
+        auto finish = m_now();
         m_output << m_name << " took "
                  << std::chrono::duration_cast<std::chrono::seconds>(finish - m_start).count()
                  << " seconds." << std::endl;
@@ -113,9 +940,56 @@ public:
     /**
      * @brief Update the internal counter based on update().
      *
-     * default is 1. Then prints the progress bar/counter to the ostream.
+     * default is 1. Then prints the progress bar/counter to the ostream, but only if the counter
+     * crossed the next tick threshold. The common case is one add and one compare. The counter is
+     * stored as a relaxed atomic, which is a plain store on the usual hardware, so that an
+     * async() renderer can read it.
+     */
+    void push() { add(m_update); }
+
+    /**
+     * @brief Add n to the internal counter, instead of the update() step. For when the loop
+     * advances by varying amounts, like the bytes of every read.
+     *
+     * Prints like push() does. In a coroutine it can be awaited, `co_await bar.add(n)`.
+     *
+     * @param n how much to add
+     * @return Step
+     */
+    Step add(int64_t n) {
+        int64_t counter = m_counter + n;
+        std::atomic_ref<int64_t>(m_counter).store(counter, std::memory_order_relaxed);
+        if (counter < m_next_threshold) [[likely]] {
+            return {};
+        }
+        render();
+        return {};
+    }
+
+    /**
+     * @brief add() for a coroutine, `co_await bar.step()`. Like push() and add() only for one
+     * thread at a time, coroutines resumed on many threads want a ConcurrentProgress.
+     *
+     * @param n how much to add
+     * @return Step
+     */
+    Step step(int64_t n = 1) { return add(n); }
+
+    /**
+     * @brief Set the internal counter directly, and print if that crossed the next tick.
+     *
+     * For when the counting happens somewhere else, like ConcurrentProgress summing up its
+     * per-thread counters.
+     *
+     * @param counter the new counter value
      */
-    void push();
+    void set(int64_t counter) {
+        std::atomic_ref<int64_t>(m_counter).store(counter, std::memory_order_relaxed);
+        if (counter < m_next_threshold) {
+            return;
+        }
+        render();
+    }
 
     /**
      * @brief just a print of std::endl to ostream.
@@ -129,7 +1003,32 @@ public:
      * @return true yes, so you can terminate the loop
      * @return false no, so continue the loop
      */
-    bool finished() const { return m_counter < m_total; }
+    bool finished() const { return m_counter < m_last_count; }
+
+    /**
+     * @brief the internal counter. Safe to read from another thread while the loop runs, e.g. a
+     * Watchdog.
+     *
+     * @return int64_t the counter
+     */
+    int64_t count() const {
+        return std::atomic_ref<int64_t>(const_cast<int64_t &>(m_counter))
+            .load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief the total, or unknown_total.
+     *
+     * @return int64_t
+     */
+    int64_t total() const { return m_total; }
+
+    /**
+     * @brief the name of the bar.
+     *
+     * @return const std::string&
+     */
+    const std::string &name() const { return m_name; }
 
     /**
      * @brief returns an iterator that points to the current value of the internal counter.
@@ -158,7 +1057,17 @@ public:
      * @param ticks_
      * @return Progress&
      */
-    Progress &ticks(int ticks_);
+    Progress &ticks(int64_t ticks_);
+
+    /**
+     * @brief Set the total, e.g. once it becomes known in the middle of an unknown_total loop. The
+     * bar turns into a normal one with a bar, percentage and ET from the next print on. Ticks
+     * that were never set become the total, like in the constructor.
+     *
+     * @param total the new total, or unknown_total
+     * @return Progress&
+     */
+    Progress &total(int64_t total);
 
     /**
      * @brief Set how much the counter should be incremented each time. Default 1
@@ -166,7 +1075,7 @@ public:
      * @param count value to update the internal counter by
      * @return Progress&
      */
-    Progress &update(int count);
+    Progress &update(int64_t count);
 
     /**
      * @brief Flag to control the display of the bar.
@@ -185,14 +1094,19 @@ public:
     Progress &length(int bar_length);
 
     /**
-     * @brief Style of the bar display. Should be a string of 4 characters.
+     * @brief Style of the bar display. A utf-8 string of at least 4 characters.
      *
      * Default [# ], which means the opening character is [, the character for percentage done is #,
-     * the remaining part character ' ' and the closing character is ]. Can't really handle the
-     * larger unicode character set i think. Maybe I'll imporve on that in the future.
+     * the remaining part character ' ' and the closing character is ]. Characters between the
+     * remaining and the closing one are for a partly done cell, from least to most done. With
+     * seven of them, like eighth_blocks, the bar moves by an eighth of a cell. Characters that
+     * take two columns work too, the narrower ones are padded to the same width.
+     *
+     * Every state the bar can be in is drawn once here, a render copies the right one.
      *
      * @param style
      * @return Progress&
+     * @throws std::invalid_argument with fewer than 4 characters
      */
     Progress &style(std::string_view style);
 
@@ -204,101 +1118,1137 @@ public:
      */
     Progress &name(std::string_view name);
 
-private:
-    int32_t m_total{};
-    int32_t m_counter{};
-    int m_update{1};
-    int32_t m_ticks{};
-    int32_t m_next_tick{};
-    bool m_show_bar{true};
-    int m_bar_length{20};
-    std::string m_style{"[# ]"};
-    std::string m_name{"Progress"};
-
-    std::ostream &m_output{std::cout};
-    std::chrono::time_point<std::chrono::high_resolution_clock> m_start;
+    /**
+     * @brief How the counter, total and rate are written. Default format::count, plain numbers.
+     *
+     * @param format e.g. format::bytes, or your own function
+     * @return Progress&
+     */
+    Progress &units(format::Unit format);
 
-};
+    /**
+     * @brief Flag to control the display of the rate, counts per second since the start. Default
+     * false.
+     *
+     * @param show if true, the rate is shown after the percentage
+     * @return Progress&
+     */
+    Progress &show_rate(bool show);
 
-inline Progress::Progress(int32_t total, std::ostream &ostream)
-    : m_total(total), m_ticks(total), m_output(ostream) {
-    m_start = std::chrono::high_resolution_clock::now();
-}
-inline Progress::Progress(int32_t total, int32_t ticks, std::ostream &ostream)
-    : m_total(total), m_ticks(ticks), m_output(ostream) {
-    m_start = std::chrono::high_resolution_clock::now();
-}
+    /**
+     * @brief Count bytes. Same as units(format::bytes).show_rate(true), so the line shows e.g.
+     * 1.5 GiB / 10.0 GiB and 120.3 MiB/s. Use add() with the size of every read.
+     *
+     * @return Progress&
+     */
+    Progress &bytes();
 
-inline void Progress::push() {
-    m_counter += m_update;
-    int current_tick = static_cast<int>(std::floor(static_cast<long double>(m_counter * m_ticks) /
-                                  static_cast<long double>(m_total)));
-    if (current_tick < m_next_tick) {
-        return;
-    }
-    m_next_tick = current_tick + 1;
+    /**
+     * @brief How the rate and ET are worked out. By default it's counter / elapsed time, with an
+     * estimator the ET is elapsed + what's left / rate, and it shows the band of the estimate,
+     * e.g. ET: 2m:10s (2m:1s-2m:24s).
+     *
+     * @param estimator e.g. EwmaEstimator or WindowEstimator, nullptr for the default
+     * @return Progress&
+     */
+    Progress &estimator(std::unique_ptr<RateEstimator> estimator);
 
-    std::stringstream percstr;
-    percstr << std::setw(4) << std::floor(current_tick * 100. / static_cast<long double>(m_ticks))
-            << "%";
+    /**
+     * @brief the estimate as of the last print. Without an estimator() it's counter / elapsed
+     * time.
+     *
+     * @return Rate
+     */
+    Rate rate() const;
 
-    m_output << ' ' << m_name << " : ";
+    /**
+     * @brief Time the increments into a LatencyHistogram, and print a PerfReport instead of the
+     * time taken at the end. Every k-th increment reads the clock and records the mean latency of
+     * the k increments since the last read. Off by default, it costs a call and a clock read per
+     * sample.
+     *
+     * @param every k, 1 to time every single increment
+     * @return Progress&
+     */
+    Progress &instrument(int64_t every = 1);
+
+    /**
+     * @brief Where the bar reads the time. Default default_clock(), tsc_clock() is cheaper, which
+     * matters with instrument(1). Set it first, times from before and after don't mix.
+     *
+     * @param now the Clock
+     * @return Progress&
+     */
+    Progress &clock(Clock now);
+
+    /**
+     * @brief what instrument() measured so far. Empty latencies if it wasn't on.
+     *
+     * @return PerfReport
+     */
+    PerfReport report() const;
+
+    /**
+     * @brief Minimum time between two prints of the bar. Default 0, i.e. only ticks() throttles.
+     *
+     * A print then needs both a new tick and the interval to have passed since the last print. The
+     * clock isn't read on every push(), only every so many increments, where that number follows
+     * the observed iteration rate. The first and the last tick are always printed.
+     *
+     * @param interval minimum time between prints
+     * @return Progress&
+     */
+    template <typename Rep, typename Period>
+    Progress &min_interval(std::chrono::duration<Rep, Period> interval);
+
+    /**
+     * @brief Maximum number of prints per second. Same as min_interval(1s / fps).
+     *
+     * @param fps prints per second. <= 0 turns the time throttle off
+     * @return Progress&
+     */
+    Progress &max_fps(double fps);
+
+    /**
+     * @brief Print from a background thread instead of from push().
+     *
+     * push() then only stores the counter. The thread owned by the bar looks at it every refresh
+     * and does the formatting and writing, so the loop never waits on the ostream. The thread is
+     * joined in ~Progress(). Call this last, the other settings must not change while the thread
+     * runs.
+     *
+     * @param refresh how often the thread looks at the counter. Default 100ms
+     * @return Progress&
+     */
+    Progress &async(std::chrono::milliseconds refresh = std::chrono::milliseconds(100));
+
+    /**
+     * @brief Send the lines to sink instead of the ostream, e.g. a MultiProgress that shows many
+     * bars at once. The bar then doesn't print the new line and the time taken at the end either.
+     *
+     * @param sink where the lines go. Has to outlive the bar
+     * @return Progress&
+     */
+    Progress &group(LineSink &sink);
+
+    /**
+     * @brief Send the counter to sink on every tick instead of printing anything, e.g. a
+     * SharedExport that another process reads. Nothing is written to the ostream, not even at the
+     * end, but for the report of instrument(). Set the name() and ticks() first, the sink gets the name now and a count on every tick.
+     * If the ticks are still the total, there are 1000 of them at most, so the sink isn't called
+     * on every push.
+     *
+     * @param sink where the counts go. Has to outlive the bar
+     * @return Progress&
+     */
+    Progress &publish(CountSink &sink);
+
+    /**
+     * @brief How the bar is written. Default Output::automatic, which redraws the line in place on
+     * a terminal and writes a line every 10 seconds to anything else, so a log file stays small no
+     * matter how many iterations there are. min_interval() sets a different interval.
+     *
+     * @param mode one of Output
+     * @return Progress&
+     */
+    Progress &output(Output mode);
+
+    /**
+     * @brief On a terminal, only send the characters that changed since the last line, skipping
+     * over the rest with cursor movements, and nothing at all if the line is the same. Default
+     * true. Columns are display widths, see detail::cell_size(), so wide characters count as two.
+     *
+     * @param on false to rewrite the whole line every time
+     * @return Progress&
+     */
+    Progress &differential(bool on);
+
+private:
+    /**
+     * @brief resize the line buffer to fit the longest line the current settings can produce.
+     *
+     * Called on construction and by the setters that change the line length, so that render()
+     * never allocates.
+     */
+    void size_line();
+
+    /**
+     * @brief draw every state of the bar into m_bars, for the current style and length.
+     */
+    void build_bars();
+
+    /**
+     * @brief the bar with step sub cells done, drawn from m_glyphs.
+     */
+    char *append_bar(char *out, int64_t step) const;
+
+    /**
+     * @brief format the status line into the line buffer.
+     *
+     * @param counter the counter value to show
+     * @param current_tick the tick to draw the bar and percentage for
+     * @param now time used for the elapsed and ET columns
+     * @return std::size_t number of characters written
+     */
+    std::size_t compose(int64_t counter, int64_t current_tick,
+                        std::chrono::time_point<std::chrono::high_resolution_clock> now);
+
+    /**
+     * @brief format the Output::json record into the line buffer.
+     *
+     * @return std::size_t number of characters written
+     */
+    std::size_t compose_json(int64_t counter,
+                             std::chrono::time_point<std::chrono::high_resolution_clock> now);
+
+    /**
+     * @brief " <rate>/s", counts per second since the start, in the units() format.
+     */
+    char *append_rate(char *out, int64_t counter,
+                      std::chrono::time_point<std::chrono::high_resolution_clock> now) const;
+
+    /**
+     * @brief " ET: <time>", plus the band if the estimator has one.
+     */
+    char *append_eta(char *out, int64_t counter,
+                     std::chrono::time_point<std::chrono::high_resolution_clock> now) const;
+
+    /**
+     * @brief the escapes and characters that turn the last line on the terminal into the one in
+     * m_line, into m_frame. Leaves the cursor at the start of the line.
+     *
+     * @param length length of the line in m_line
+     * @return std::size_t bytes in m_frame, 0 if the line didn't change
+     */
+    std::size_t diff_frame(std::size_t length);
+
+    /**
+     * @brief compose() and write the line to the ostream in one go.
+     */
+    void print(int64_t counter, int64_t current_tick,
+               std::chrono::time_point<std::chrono::high_resolution_clock> now);
+
+    /**
+     * @brief the time throttle part of render(). Decides whether a print is allowed now, and
+     * re-estimates after how many increments the clock should be read again.
+     *
+     * @param now current time
+     * @return true the interval has passed, print
+     * @return false too early, m_next_threshold was moved to the next clock check
+     */
+    bool interval_passed(std::chrono::time_point<std::chrono::high_resolution_clock> now);
+
+    /**
+     * @brief the slow path of push(). Takes an instrument() sample, works out the current tick,
+     * moves the threshold to the next one and prints the bar. Kept out of line so push() stays
+     * small enough to inline.
+     */
+    void render();
+
+    /**
+     * @brief render() after the sample.
+     */
+    void draw(std::chrono::time_point<std::chrono::high_resolution_clock> now);
+
+    /**
+     * @brief record the mean latency since the last sample, and when the next one is due.
+     */
+    void sample(std::chrono::time_point<std::chrono::high_resolution_clock> now);
+
+    /**
+     * @brief pull m_next_threshold in to the next instrument() sample.
+     */
+    void sample_threshold() {
+        if (m_histogram) {
+            m_next_threshold = std::min(m_next_threshold, m_sample_next);
+        }
+    }
+
+    /**
+     * @brief the PerfReport as one line, in place of "took N seconds".
+     */
+    void print_report();
+
+    /**
+     * @brief the PerfReport line into m_line, without the new line.
+     *
+     * @return std::size_t the length
+     */
+    std::size_t compose_report();
+
+    /**
+     * @brief the PerfReport as a json object into m_line, without the new line.
+     *
+     * @return std::size_t the length
+     */
+    std::size_t compose_report_json();
+
+    /**
+     * @brief smallest counter value at which tick is reached, i.e. ceil(tick * total / ticks).
+     *
+     * @param tick the tick to compute the threshold for
+     * @return int64_t counter threshold
+     */
+    int64_t threshold(int64_t tick) const;
+
+    /**
+     * @brief the tick counter is in. With an unknown total every count is a tick.
+     *
+     * @param counter the counter value
+     * @return int64_t the tick
+     */
+    int64_t tick_of(int64_t counter) const;
+
+    /**
+     * @brief the counter value of the last tick. total, or the largest int64_t if that's unknown.
+     */
+    int64_t last_count() const { return m_last_count; }
+
+    /**
+     * @brief body of the async() renderer thread.
+     *
+     * @param refresh time between two looks at the counter
+     */
+    void run_async(std::chrono::milliseconds refresh);
+
+    /**
+     * @brief tell the async() renderer thread to stop and join it.
+     */
+    void stop_async();
+
+    int64_t m_total{};
+    // total, or the largest int64_t for an unknown total. So finished() is a single compare
+    int64_t m_last_count{};
+    // atomic_ref needs it aligned, which int64_t isn't everywhere
+    alignas(std::atomic_ref<int64_t>::required_alignment) int64_t m_counter{};
+    int64_t m_update{1};
+    int64_t m_ticks{};
+    int64_t m_next_tick{};
+    // counter value at which render() needs to run next, either because the next tick is crossed
+    // or the clock needs checking. push() only compares against this.
+    int64_t m_next_threshold{};
+    // the same without the instrument() samples, where draw() has something to do
+    int64_t m_draw_threshold{};
+
+    // time throttle, off when zero
+    std::chrono::high_resolution_clock::duration m_min_interval{};
+    // min_interval() was called, output() leaves m_min_interval alone then
+    bool m_min_interval_set{false};
+    // increments between two clock reads, adapted to the iteration rate
+    int64_t m_clock_stride{1};
+    int64_t m_clock_counter{};
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_clock_time;
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_last_print;
+    bool m_show_bar{true};
+    int m_bar_length{20};
+    std::string m_style{"[# ]"};
+    // the characters of the style: opening, done, remaining, the partly done ones, closing. The
+    // middle ones padded to the same width
+    std::vector<std::string> m_glyphs;
+    // steps per cell, 1 + the partly done characters
+    int64_t m_cell_steps{1};
+    // every state of the bar back to back, step i is [m_bar_offsets[i], m_bar_offsets[i + 1]).
+    // Empty if that would be too big, then render() draws the bar itself
+    std::string m_bars;
+    std::vector<uint32_t> m_bar_offsets;
+    // bytes of the longest state
+    std::size_t m_bar_size{0};
+    std::string m_name{"Progress"};
+    format::Unit m_format{format::count};
+    bool m_show_rate{false};
+    // unknown_total: the next frame of the spinner
+    std::size_t m_spinner{0};
+    // nullptr for counter / elapsed, without a virtual call
+    std::unique_ptr<RateEstimator> m_estimator;
+
+    // reused for every render. sized by size_line()
+    std::string m_line;
+    // differential() mode: the line on the terminal, and the bytes that update it
+    bool m_differential{true};
+    std::string m_previous;
+    std::string m_frame;
+    // the counter value and time of the last line printed
+    int64_t m_printed{};
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_last_print_time;
+
+    std::ostream &m_output{std::cout};
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_start;
+
+    // never Output::automatic, that's resolved in output()
+    Output m_output_mode{Output::terminal};
+
+    Clock m_now{default_clock};
+
+    // instrument() mode, nullptr when off
+    std::unique_ptr<LatencyHistogram> m_histogram;
+    int64_t m_sample_every{1};
+    int64_t m_sample_count{0};
+    int64_t m_sample_next{0};
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_sample_time;
+    // set by the destructor, so report() stops counting time after that
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_finish;
+
+    // group() mode, nullptr when printing to m_output
+    LineSink *m_sink{nullptr};
+    std::size_t m_slot{};
+
+    // publish() mode, nullptr when printing
+    CountSink *m_count_sink{nullptr};
+    std::size_t m_count_slot{};
+
+    // async() mode
+    bool m_async{false};
+    bool m_renderer_stop{false};
+    std::mutex m_renderer_mutex;
+    std::condition_variable m_renderer_wake;
+    std::thread m_renderer;
+
+};
+
+inline Progress::Progress(int64_t total, std::ostream &ostream)
+    : Progress(total, total, ostream) {}
+
+inline Progress::Progress(int64_t total, int64_t ticks, std::ostream &ostream)
+    : m_total(total), m_last_count(total), m_ticks(ticks), m_output(ostream) {
+    if (m_total == unknown_total) {
+        m_last_count = std::numeric_limits<int64_t>::max();
+        // the rate is all there is to go by, so smooth it
+        m_show_rate = true;
+        m_estimator = std::make_unique<EwmaEstimator>();
+    }
+    // the first tick, or never with ticks(0)
+    m_next_threshold = threshold(m_next_tick);
+    m_draw_threshold = m_next_threshold;
+    style(std::string(m_style));
+    output(Output::automatic);
+    m_start = m_now();
+    m_clock_time = m_start;
+}
+
+inline int64_t Progress::threshold(int64_t tick) const {
+    // in async() mode push() never prints
+    if (m_async || (m_ticks <= 0 && m_total != unknown_total)) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    if (m_total == unknown_total) {
+        return tick;
+    }
+    return detail::muldiv_ceil(tick, m_total, m_ticks);
+}
+
+inline int64_t Progress::tick_of(int64_t counter) const {
+    if (m_total == unknown_total) {
+        return counter;
+    }
+    return m_ticks > 0 ? detail::muldiv(counter, m_ticks, m_total) : 0;
+}
+
+inline void Progress::size_line() {
+    // " <name> : [<bar>] <counter> / <total> <perc>% <rate>/s Elapsed: <time> ET: <time>\r"
+    // and " (<time>-<time>)" after the ET with an estimator
+    constexpr std::string_view fixed = "  :  /  %  /s Elapsed:  ET:  (-)\r";
+    std::size_t length = m_name.size() + fixed.size() + 3 * format::max_chars +
+                         detail::max_int_chars + 4 * detail::max_duration_chars;
+    if (m_show_bar) {
+        length += m_bar_size;
+    }
+    // {"name":"","count":,"total":,"rate":,"elapsed":,"eta":}\n
+    std::size_t json = 6 * m_name.size() + 64 + 5 * detail::max_int_chars + 3 * 32;
+    m_line.resize(std::max(length, json));
+    // a cursor movement costs at most twice the characters it skips, or they get rewritten
+    m_frame.resize(3 * m_line.size() + 32);
+    m_previous.reserve(m_line.size());
+}
+
+inline void Progress::build_bars() {
+    int64_t cells = std::max(m_bar_length, 0);
+    std::size_t widest = 0;
+    for (std::size_t i = 1; i + 1 < m_glyphs.size(); i++) {
+        widest = std::max(widest, m_glyphs[i].size());
+    }
+    m_bar_size = m_glyphs.front().size() + static_cast<std::size_t>(cells) * widest +
+                 m_glyphs.back().size();
+    m_bars.clear();
+    m_bar_offsets.clear();
+    // a few hundred states of a few dozen bytes usually. Not for a bar as wide as a screen of
+    // emoji, that's drawn on every render instead
+    int64_t steps = cells * m_cell_steps;
+    if (static_cast<double>(steps + 1) * static_cast<double>(m_bar_size) > (1 << 20)) {
+        return;
+    }
+    m_bars.resize(static_cast<std::size_t>(steps + 1) * m_bar_size);
+    m_bar_offsets.reserve(static_cast<std::size_t>(steps + 2));
+    char *out = m_bars.data();
+    for (int64_t step = 0; step <= steps; step++) {
+        m_bar_offsets.push_back(static_cast<uint32_t>(out - m_bars.data()));
+        out = append_bar(out, step);
+    }
+    m_bar_offsets.push_back(static_cast<uint32_t>(out - m_bars.data()));
+    m_bars.resize(m_bar_offsets.back());
+}
+
+inline char *Progress::append_bar(char *out, int64_t step) const {
+    int64_t cells = std::max(m_bar_length, 0);
+    int64_t done = step / m_cell_steps;
+    int64_t part = step % m_cell_steps;
+    out = detail::append(out, m_glyphs.front());
+    for (int64_t cell = 0; cell < cells; cell++) {
+        if (cell < done) {
+            out = detail::append(out, m_glyphs[1]);
+        } else if (cell == done && part > 0) {
+            // the partly done characters start at 3
+            out = detail::append(out, m_glyphs[static_cast<std::size_t>(2 + part)]);
+        } else {
+            out = detail::append(out, m_glyphs[2]);
+        }
+    }
+    return detail::append(out, m_glyphs.back());
+}
+
+inline std::size_t Progress::compose(
+    int64_t counter, int64_t current_tick,
+    std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+    char *out = m_line.data();
+    out = detail::append(out, ' ');
+    out = detail::append(out, m_name);
+    out = detail::append(out, " : ");
+    if (m_estimator) {
+        m_estimator->sample(now - m_start, counter);
+    }
+    if (m_total == unknown_total) {
+        // no bar, percentage or ET without a total. A spinner, so it's clear the loop is moving
+        constexpr char spinner[] = {'|', '/', '-', '\\'};
+        out = detail::append(out, spinner[m_spinner++ % sizeof(spinner)]);
+        out = detail::append(out, ' ');
+        out = m_format(out, counter);
+        if (m_show_rate) {
+            out = append_rate(out, counter, now);
+        }
+        out = detail::append(out, " Elapsed: ");
+        out = detail::append(out, now - m_start);
+        return static_cast<std::size_t>(out - m_line.data());
+    }
+    int64_t ticks = m_ticks;
+    if (ticks <= 0) {
+        // ticks(0) never prints by itself, but async() and ~Progress() still may. No ticks to go
+        // by, only the counter
+        current_tick = counter;
+        ticks = std::max<int64_t>(m_total, 1);
+    }
     if (m_show_bar) {
-        m_output << m_style[0];
-        std::string donebar(m_bar_length, m_style[2]);
-        donebar.replace(0, static_cast<size_t>(std::floor(current_tick * static_cast<long double>(m_bar_length) / m_ticks)),
-                        static_cast<size_t>(std::floor(current_tick * static_cast<long double>(m_bar_length) / m_ticks)),
-                        m_style[1]);
-        m_output << donebar;
-        m_output << m_style[3];
-    }
-    m_output << ' ' << m_counter << " / " << m_total;
-    m_output << ' ' << percstr.str();
-    auto time_print = [&](const auto &time) {
-        auto mins = std::chrono::duration_cast<std::chrono::minutes>(time);
-        auto secs = std::chrono::duration_cast<std::chrono::seconds>(time - mins);
-        m_output << mins.count() << "m:" << secs.count() << "s";
+        int64_t steps = std::max(m_bar_length, 0) * m_cell_steps;
+        int64_t step = std::clamp<int64_t>(detail::muldiv(current_tick, steps, ticks), 0, steps);
+        if (m_bar_offsets.empty()) {
+            out = append_bar(out, step);
+        } else {
+            auto index = static_cast<std::size_t>(step);
+            out = detail::append(out, std::string_view(m_bars).substr(
+                                          m_bar_offsets[index],
+                                          m_bar_offsets[index + 1] - m_bar_offsets[index]));
+        }
+    }
+    out = detail::append(out, ' ');
+    out = m_format(out, counter);
+    out = detail::append(out, " / ");
+    out = m_format(out, m_total);
+    out = detail::append(out, ' ');
+    out = detail::append(out, detail::muldiv(current_tick, 100, ticks), 4);
+    out = detail::append(out, '%');
+    if (m_show_rate) {
+        out = append_rate(out, counter, now);
+    }
+
+    out = detail::append(out, " Elapsed: ");
+    out = detail::append(out, now - m_start);
+    out = append_eta(out, counter, now);
+    return static_cast<std::size_t>(out - m_line.data());
+}
+
+inline char *Progress::append_eta(
+    char *out, int64_t counter,
+    std::chrono::time_point<std::chrono::high_resolution_clock> now) const {
+    using duration = std::chrono::high_resolution_clock::duration;
+    out = detail::append(out, " ET: ");
+    auto elapsed = now - m_start;
+    if (!m_estimator) {
+        if (counter <= 0) {
+            return detail::append(out, "?");
+        }
+        return detail::append(out, duration(detail::muldiv(elapsed.count(), m_total, counter)));
+    }
+
+    // elapsed + whatever is left at the given rate
+    auto total_time = [&](char *at, double rate) {
+        double left = static_cast<double>(std::max<int64_t>(m_total - counter, 0));
+        double seconds = left / rate;
+        if (!(rate > 0) || seconds > 1e9) {
+            return detail::append(at, "?");
+        }
+        auto remaining =
+            std::chrono::duration_cast<duration>(std::chrono::duration<double>(seconds));
+        return detail::append(at, elapsed + remaining);
+    };
+    Rate rate = m_estimator->rate();
+    out = total_time(out, rate.per_second);
+    if (rate.low < rate.high) {
+        // the faster rate is the earlier end
+        out = detail::append(out, " (");
+        out = total_time(out, rate.high);
+        out = detail::append(out, '-');
+        out = total_time(out, rate.low);
+        out = detail::append(out, ')');
+    }
+    return out;
+}
+
+inline std::size_t Progress::compose_json(
+    int64_t counter, std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+    auto append_double = [](char *out, double value) {
+        return std::to_chars(out, out + 32, value, std::chars_format::fixed, 3).ptr;
     };
-    auto now = std::chrono::high_resolution_clock::now();
-    m_output << " Elapsed: ";
-    time_print(now - m_start);
+    double elapsed = std::chrono::duration<double>(now - m_start).count();
+    if (m_estimator) {
+        m_estimator->sample(now - m_start, counter);
+    }
+    double rate = m_estimator ? m_estimator->rate().per_second
+                              : (elapsed > 0 ? static_cast<double>(counter) / elapsed : 0.);
+
+    char *out = m_line.data();
+    out = detail::append(out, "{\"name\":\"");
+    out = detail::append_json(out, m_name);
+    out = detail::append(out, "\",\"count\":");
+    out = detail::append(out, counter);
+    out = detail::append(out, ",\"total\":");
+    if (m_total == unknown_total) {
+        out = detail::append(out, "null");
+    } else {
+        out = detail::append(out, m_total);
+    }
+    out = detail::append(out, ",\"rate\":");
+    out = append_double(out, rate);
+    out = detail::append(out, ",\"elapsed\":");
+    out = append_double(out, elapsed);
+    out = detail::append(out, ",\"eta\":");
+    if (m_total == unknown_total || !(rate > 0)) {
+        out = detail::append(out, "null");
+    } else {
+        auto left = static_cast<double>(std::max<int64_t>(m_total - counter, 0));
+        out = append_double(out, left / rate);
+    }
+    out = detail::append(out, '}');
+    return static_cast<std::size_t>(out - m_line.data());
+}
+
+inline char *Progress::append_rate(
+    char *out, int64_t counter,
+    std::chrono::time_point<std::chrono::high_resolution_clock> now) const {
+    using period = std::chrono::high_resolution_clock::period;
+    int64_t elapsed = (now - m_start).count();
+    out = detail::append(out, ' ');
+    if (m_estimator) {
+        double per_second = std::min(m_estimator->rate().per_second, 9e18);
+        out = m_format(out, static_cast<int64_t>(std::max(per_second, 0.)));
+        return detail::append(out, "/s");
+    }
+    if (elapsed <= 0) {
+        return detail::append(out, "?/s");
+    }
+    out = m_format(out, detail::muldiv(counter, period::den, elapsed * period::num));
+    return detail::append(out, "/s");
+}
+
+inline bool Progress::interval_passed(
+    std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+    // how many increments would fit in the interval at the rate seen since the last clock read
+    int64_t counted = m_counter - m_clock_counter;
+    auto waited = now - m_clock_time;
+    if (waited.count() > 0) {
+        long double per_interval = static_cast<long double>(counted) * m_min_interval.count() /
+                                   static_cast<long double>(waited.count());
+        m_clock_stride = std::max<int64_t>(
+            1, static_cast<int64_t>(std::min<long double>(per_interval, last_count())));
+    } else {
+        m_clock_stride = std::min<int64_t>(detail::add_saturated(m_clock_stride, m_clock_stride),
+                                           std::max<int64_t>(last_count(), 1));
+    }
+    m_clock_counter = m_counter;
+    m_clock_time = now;
+
+    // always print the first and the last tick
+    if (m_next_tick == 0 || m_counter >= last_count() || now - m_last_print >= m_min_interval) {
+        return true;
+    }
+    auto remaining = m_min_interval - (now - m_last_print);
+    int64_t wait = std::max<int64_t>(
+        1, detail::muldiv(m_clock_stride, remaining.count(), m_min_interval.count()));
+    m_next_threshold = std::min(detail::add_saturated(m_counter, wait), last_count());
+    m_draw_threshold = m_next_threshold;
+    return false;
+}
+
+PROGRESS_NOINLINE inline void Progress::render() {
+    auto now = m_now();
+    if (!m_histogram) [[likely]] {
+        draw(now);
+        return;
+    }
+    sample(now);
+    // a sample alone is no reason to print, only a tick or a clock check. In async() mode only
+    // the renderer thread draws
+    if (!m_async && m_counter >= m_draw_threshold) {
+        draw(now);
+    }
+    m_next_threshold = m_draw_threshold;
+    sample_threshold();
+}
+
+inline void Progress::sample(std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+    int64_t counted = m_counter - m_sample_count;
+    if (counted > 0) {
+        auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_sample_time);
+        m_histogram->record(waited.count() / counted, counted);
+    }
+    m_sample_count = m_counter;
+    m_sample_time = now;
+    m_sample_next = detail::add_saturated(m_counter, m_sample_every);
+}
+
+inline void Progress::draw(std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+    if (m_min_interval.count() > 0) {
+        if (!interval_passed(now)) {
+            return;
+        }
+        m_last_print = now;
+    }
+    int64_t current_tick = tick_of(m_counter);
+    m_next_tick = current_tick + 1;
+    m_next_threshold = threshold(m_next_tick);
+    if (m_min_interval.count() > 0) {
+        // don't come back before the next print is allowed, but don't skip the last tick either
+        int64_t next_check =
+            std::min(detail::add_saturated(m_counter, m_clock_stride), last_count());
+        m_next_threshold = std::max(m_next_threshold, next_check);
+    }
+    m_draw_threshold = m_next_threshold;
 
-    auto total = (now - m_start) * m_total / m_counter;
-    m_output << " ET: ";
-    time_print(total);
-    m_output << '\r';
-    m_output << std::flush;
+    print(m_counter, current_tick, now);
 }
 
-inline void Progress::keep() { m_output << std::endl; }
+inline void Progress::print(int64_t counter, int64_t current_tick,
+                            std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+    m_printed = counter;
+    m_last_print_time = now;
+    if (m_count_sink != nullptr) {
+        m_count_sink->count(m_count_slot, counter);
+        return;
+    }
+    if (m_output_mode == Output::json && m_sink == nullptr) {
+        std::size_t length = compose_json(counter, now);
+        m_line[length] = '\n';
+        m_output.write(m_line.data(), static_cast<std::streamsize>(length + 1));
+        m_output.flush();
+        return;
+    }
+    std::size_t length = compose(counter, current_tick, now);
+    if (m_sink != nullptr) {
+        m_sink->line(m_slot, std::string_view(m_line.data(), length));
+        return;
+    }
+    if (m_output_mode == Output::terminal && m_differential) {
+        std::size_t size = diff_frame(length);
+        if (size > 0) {
+            m_output.write(m_frame.data(), static_cast<std::streamsize>(size));
+            m_output.flush();
+        }
+        return;
+    }
+    m_line[length] = m_output_mode == Output::terminal ? '\r' : '\n';
+    m_output.write(m_line.data(), static_cast<std::streamsize>(length + 1));
+    m_output.flush();
+}
+
+inline std::size_t Progress::diff_frame(std::size_t length) {
+    const char *line = m_line.data();
+    const char *line_end = line + length;
+    const char *old = m_previous.data();
+    const char *old_end = old + m_previous.size();
+    char *out = m_frame.data();
+
+    // the cursor is at the start of the line, where the last frame left it
+    std::size_t cursor = 0;
+    const char *cursor_at = line;
+    auto move_to = [&](std::size_t column, const char *at) {
+        // "\x1b[<n>C" or the characters in between, whichever is shorter
+        if (at - cursor_at <= 4) {
+            std::memcpy(out, cursor_at, static_cast<std::size_t>(at - cursor_at));
+            out += at - cursor_at;
+        } else {
+            out = detail::append(out, "\x1b[");
+            out = detail::append(out, static_cast<int64_t>(column - cursor));
+            out = detail::append(out, 'C');
+        }
+        cursor = column;
+        cursor_at = at;
+    };
 
-inline Progress &Progress::ticks(int ticks_) {
+    std::size_t column = 0;
+    while (line < line_end) {
+        if (old < old_end && *line == *old && static_cast<unsigned char>(*line) < 0x80) {
+            // the same ascii character, most of every line
+            line++;
+            old++;
+            column++;
+            continue;
+        }
+        int width;
+        int old_width = 0;
+        std::size_t size = detail::cell_size(line, line_end, width);
+        std::size_t old_size = old < old_end ? detail::cell_size(old, old_end, old_width) : 0;
+        if (old_size > 0 && width != old_width) {
+            // the columns after this one don't line up with the old line anymore, rewrite the rest
+            move_to(column, line);
+            std::memcpy(out, line, static_cast<std::size_t>(line_end - line));
+            out += line_end - line;
+            out = detail::append(out, "\x1b[K");
+            line = line_end;
+            old = old_end;
+            break;
+        }
+        if (size != old_size || std::memcmp(line, old, size) != 0) {
+            move_to(column, line);
+            std::memcpy(out, line, size);
+            out += size;
+            cursor = column + static_cast<std::size_t>(width);
+            cursor_at = line + size;
+        }
+        line += size;
+        old += old_size;
+        column += static_cast<std::size_t>(width);
+    }
+    if (old < old_end) {
+        // the old line was longer
+        move_to(column, line);
+        out = detail::append(out, "\x1b[K");
+    }
+    if (out == m_frame.data()) {
+        return 0;
+    }
+    *out++ = '\r';
+    m_previous.assign(m_line.data(), length);
+    return static_cast<std::size_t>(out - m_frame.data());
+}
+
+inline void Progress::run_async(std::chrono::milliseconds refresh) {
+    int64_t last_tick = -1;
+    std::unique_lock lock(m_renderer_mutex);
+    while (!m_renderer_wake.wait_for(lock, refresh, [this] { return m_renderer_stop; })) {
+        int64_t counter = std::atomic_ref<int64_t>(m_counter).load(std::memory_order_relaxed);
+        int64_t current_tick = tick_of(counter);
+        // like push(), only print when there's a new tick
+        if (counter == 0 || current_tick == last_tick) {
+            continue;
+        }
+        last_tick = current_tick;
+        print(counter, current_tick, m_now());
+    }
+}
+
+inline void Progress::stop_async() {
+    {
+        std::lock_guard lock(m_renderer_mutex);
+        m_renderer_stop = true;
+    }
+    m_renderer_wake.notify_one();
+    m_renderer.join();
+    m_renderer_stop = false;
+    m_async = false;
+}
+
+inline void Progress::keep() {
+    m_output << std::endl;
+    // the next line starts on a fresh one
+    m_previous.clear();
+}
+
+inline Progress &Progress::ticks(int64_t ticks_) {
     m_ticks = ticks_;
+    m_next_threshold = threshold(m_next_tick);
+    m_draw_threshold = m_next_threshold;
+    sample_threshold();
     return *this;
 }
 
-inline Progress &Progress::update(int count) {
+inline Progress &Progress::total(int64_t total) {
+    // the async() renderer reads the total while it prints
+    std::unique_lock lock(m_renderer_mutex, std::defer_lock);
+    if (m_async) {
+        lock.lock();
+    }
+    bool ticks_were_total = m_ticks == m_total;
+    m_total = total;
+    m_last_count = total == unknown_total ? std::numeric_limits<int64_t>::max() : total;
+    if (ticks_were_total) {
+        m_ticks = total;
+    }
+    if (!m_min_interval_set) {
+        // the default interval depends on whether the total is known
+        output(m_output_mode);
+    }
+    m_next_tick = tick_of(m_counter) + 1;
+    m_next_threshold = threshold(m_next_tick);
+    m_draw_threshold = m_next_threshold;
+    sample_threshold();
+    return *this;
+}
+
+inline Progress &Progress::update(int64_t count) {
     m_update = count;
     return *this;
 }
 
 inline Progress &Progress::show_bar(bool show) {
     m_show_bar = show;
+    size_line();
     return *this;
 }
 
 inline Progress &Progress::length(int bar_length) {
     m_bar_length = bar_length;
+    build_bars();
+    size_line();
     return *this;
 }
 
 inline Progress &Progress::style(std::string_view style) {
+    std::vector<std::string> glyphs;
+    for (const char *at = style.data(), *end = at + style.size(); at < end;) {
+        int width;
+        std::size_t size = detail::cell_size(at, end, width);
+        glyphs.emplace_back(at, size);
+        at += size;
+    }
+    if (glyphs.size() < 4) {
+        throw std::invalid_argument("progress: a style needs at least 4 characters");
+    }
+    // every cell as wide as the widest character, so the line doesn't shift as the bar fills
+    std::size_t columns = 0;
+    for (std::size_t i = 1; i + 1 < glyphs.size(); i++) {
+        columns = std::max(columns, detail::display_width(glyphs[i]));
+    }
+    for (std::size_t i = 1; i + 1 < glyphs.size(); i++) {
+        glyphs[i].append(columns - detail::display_width(glyphs[i]), ' ');
+    }
     m_style = style;
+    m_glyphs = std::move(glyphs);
+    m_cell_steps = static_cast<int64_t>(m_glyphs.size()) - 3;
+    build_bars();
+    size_line();
     return *this;
 }
 
 inline Progress &Progress::name(std::string_view name) {
     m_name = name;
+    size_line();
+    return *this;
+}
+
+inline Progress &Progress::units(format::Unit format) {
+    m_format = format;
+    return *this;
+}
+
+inline Progress &Progress::show_rate(bool show) {
+    m_show_rate = show;
+    return *this;
+}
+
+inline Progress &Progress::bytes() { return units(format::bytes).show_rate(true); }
+
+inline Progress &Progress::estimator(std::unique_ptr<RateEstimator> estimator) {
+    m_estimator = std::move(estimator);
+    return *this;
+}
+
+inline Rate Progress::rate() const {
+    if (m_estimator) {
+        return m_estimator->rate();
+    }
+    double seconds = std::chrono::duration<double>(m_last_print_time - m_start).count();
+    double per_second = seconds > 0 ? static_cast<double>(m_printed) / seconds : 0.;
+    return {per_second, per_second, per_second};
+}
+
+template <typename Rep, typename Period>
+Progress &Progress::min_interval(std::chrono::duration<Rep, Period> interval) {
+    m_min_interval =
+        std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(interval);
+    m_min_interval_set = true;
+    return *this;
+}
+
+inline Progress &Progress::max_fps(double fps) {
+    if (fps <= 0) {
+        return min_interval(std::chrono::high_resolution_clock::duration::zero());
+    }
+    return min_interval(std::chrono::duration<double>(1. / fps));
+}
+
+inline Progress &Progress::async(std::chrono::milliseconds refresh) {
+    if (m_async) {
+        stop_async();
+    }
+    m_async = true;
+    m_next_threshold = threshold(m_next_tick);
+    m_draw_threshold = m_next_threshold;
+    sample_threshold();
+    m_renderer = std::thread([this, refresh] { run_async(refresh); });
+    return *this;
+}
+
+inline Progress &Progress::instrument(int64_t every) {
+    if (!m_histogram) {
+        m_histogram = std::make_unique<LatencyHistogram>();
+    }
+    m_sample_every = std::max<int64_t>(every, 1);
+    sample(m_now());
+    sample_threshold();
+    return *this;
+}
+
+inline Progress &Progress::clock(Clock now) {
+    m_now = now;
+    m_start = m_now();
+    m_clock_time = m_start;
+    if (m_histogram) {
+        sample(m_start);
+    }
+    return *this;
+}
+
+inline PerfReport Progress::report() const {
+    using std::chrono::nanoseconds;
+    PerfReport report;
+    report.count = m_counter;
+    auto end = m_finish.time_since_epoch().count() != 0 ? m_finish
+                                                       : m_now();
+    report.wall = std::chrono::duration_cast<nanoseconds>(end - m_start);
+    double seconds = std::chrono::duration<double>(report.wall).count();
+    report.per_second = seconds > 0 ? static_cast<double>(m_counter) / seconds : 0.;
+    if (m_histogram) {
+        report.p50 = nanoseconds(m_histogram->percentile(0.5));
+        report.p90 = nanoseconds(m_histogram->percentile(0.9));
+        report.p99 = nanoseconds(m_histogram->percentile(0.99));
+        report.max = nanoseconds(m_histogram->max());
+    }
+    return report;
+}
+
+inline void Progress::print_report() {
+    std::size_t length = compose_report();
+    m_line[length] = '\n';
+    m_output.write(m_line.data(), static_cast<std::streamsize>(length + 1));
+    m_output.flush();
+}
+
+inline std::size_t Progress::compose_report() {
+    PerfReport perf = report();
+    // " <name> took <s> s, <count> at <rate>/s, p50 <t> p90 <t> p99 <t> max <t>\n"
+    m_line.resize(std::max(m_line.size(), m_name.size() + 64 + 2 * format::max_chars +
+                                              5 * detail::max_int_chars));
+    char *out = m_line.data();
+    out = detail::append(out, m_name);
+    out = detail::append(out, " took ");
+    out = detail::append_latency(out, perf.wall.count());
+    out = detail::append(out, ", ");
+    out = m_format(out, perf.count);
+    out = detail::append(out, " at ");
+    out = m_format(out, static_cast<int64_t>(perf.per_second));
+    out = detail::append(out, "/s, p50 ");
+    out = detail::append_latency(out, perf.p50.count());
+    out = detail::append(out, " p90 ");
+    out = detail::append_latency(out, perf.p90.count());
+    out = detail::append(out, " p99 ");
+    out = detail::append_latency(out, perf.p99.count());
+    out = detail::append(out, " max ");
+    out = detail::append_latency(out, perf.max.count());
+    return static_cast<std::size_t>(out - m_line.data());
+}
+
+inline std::size_t Progress::compose_report_json() {
+    PerfReport perf = report();
+    // {"name":"","report":{"count":,"wall":,"rate":,"p50_ns":,"p90_ns":,"p99_ns":,"max_ns":}}\n
+    m_line.resize(
+        std::max(m_line.size(), 6 * m_name.size() + 96 + 5 * detail::max_int_chars + 2 * 32));
+    auto append_double = [](char *out, double value) {
+        return std::to_chars(out, out + 32, value, std::chars_format::fixed, 3).ptr;
+    };
+    char *out = m_line.data();
+    out = detail::append(out, "{\"name\":\"");
+    out = detail::append_json(out, m_name);
+    out = detail::append(out, "\",\"report\":{\"count\":");
+    out = detail::append(out, perf.count);
+    out = detail::append(out, ",\"wall\":");
+    out = append_double(out, std::chrono::duration<double>(perf.wall).count());
+    out = detail::append(out, ",\"rate\":");
+    out = append_double(out, perf.per_second);
+    out = detail::append(out, ",\"p50_ns\":");
+    out = detail::append(out, static_cast<int64_t>(perf.p50.count()));
+    out = detail::append(out, ",\"p90_ns\":");
+    out = detail::append(out, static_cast<int64_t>(perf.p90.count()));
+    out = detail::append(out, ",\"p99_ns\":");
+    out = detail::append(out, static_cast<int64_t>(perf.p99.count()));
+    out = detail::append(out, ",\"max_ns\":");
+    out = detail::append(out, static_cast<int64_t>(perf.max.count()));
+    out = detail::append(out, "}}");
+    return static_cast<std::size_t>(out - m_line.data());
+}
+
+inline Progress &Progress::group(LineSink &sink) {
+    if (m_sink != nullptr) {
+        m_sink->detach(m_slot);
+    }
+    m_sink = &sink;
+    m_slot = sink.attach();
+    // the sink decides where the lines go, the bar just makes them as for a terminal
+    return output(Output::terminal);
+}
+
+inline Progress &Progress::publish(CountSink &sink) {
+    if (m_count_sink != nullptr) {
+        m_count_sink->detach(m_count_slot, m_counter);
+    }
+    m_count_sink = &sink;
+    m_count_slot = sink.attach(m_name, m_total);
+    if (m_ticks == m_total && m_total > 1000) {
+        ticks(1000);
+    }
+    // nothing is printed, so no log interval either. The ticks say how often the sink hears
+    return output(Output::terminal);
+}
+
+inline Progress &Progress::differential(bool on) {
+    m_differential = on;
+    m_previous.clear();
+    return *this;
+}
+
+inline Progress &Progress::output(Output mode) {
+    if (mode == Output::automatic) {
+        mode = detail::is_terminal(m_output) ? Output::terminal : Output::log;
+    }
+    m_output_mode = mode;
+    if (!m_min_interval_set) {
+        // every tick on a terminal, unless the ticks are unknown, then 10 per second. Logs every
+        // 10 seconds
+        if (m_output_mode != Output::terminal) {
+            m_min_interval = std::chrono::seconds(10);
+        } else if (m_total == unknown_total) {
+            m_min_interval = std::chrono::milliseconds(100);
+        } else {
+            m_min_interval = std::chrono::high_resolution_clock::duration::zero();
+        }
+    }
+    size_line();
     return *this;
 }
 
@@ -0,0 +1,317 @@
+// Progress for another process to show, e.g. a sidecar or the bundled progress_watch tool.
+//
+//     progress::SharedExport board("/dev/shm/my-job");
+//     progress::Progress bar(limit);
+//     bar.name("shards").ticks(1000).publish(board);
+//     for (auto i : bar) { ... }
+//
+//     $ progress_watch /dev/shm/my-job
+//
+// The bars write their count, total, start and last update time and name into a memory mapped
+// file. A tick is a read of system_clock, which on Linux goes through the vDSO and not a syscall,
+// and two relaxed stores into the mapping. Nothing goes to stdout. The reader maps the same file
+// and polls. POSIX only.
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace progress {
+
+namespace detail {
+// "progress" in ascii, so a reader can tell it mapped the right file
+inline constexpr uint64_t shared_magic = 0x70726f6772657373;
+inline constexpr uint32_t shared_version = 1;
+
+// the processes share the counters through the mapping, that only works if the atomics don't
+// hide a lock inside the process
+static_assert(std::atomic<int64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+enum SharedState : uint32_t { free_record, claiming_record, live_record, done_record };
+
+struct alignas(64) SharedHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    // set when the writer is gone, the reader can stop
+    std::atomic<uint32_t> closed;
+};
+
+struct alignas(64) SharedRecord {
+    std::atomic<uint32_t> state;
+    std::atomic<int64_t> count;
+    std::atomic<int64_t> total;
+    // std::chrono::system_clock nanoseconds, the same in every process
+    std::atomic<int64_t> start_ns;
+    std::atomic<int64_t> update_ns;
+    // only written while state is claiming_record, zero terminated
+    char name[80];
+};
+
+inline int64_t shared_now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+inline std::size_t shared_size(uint32_t capacity) {
+    return sizeof(SharedHeader) + capacity * sizeof(SharedRecord);
+}
+}  // namespace detail
+
+/**
+ * @brief The writing side: a memory mapped file with a record per bar. See Progress::publish().
+ */
+class SharedExport : public CountSink {
+public:
+    /**
+     * @brief Create (or truncate) the file and map it.
+     *
+     * @param path where the file goes, default_path() for /dev/shm/progress.<pid>
+     * @param capacity number of bars that can be published at once
+     */
+    explicit SharedExport(std::string path = default_path(), uint32_t capacity = 64);
+
+    /**
+     * @brief Destroy the SharedExport object. Tells the readers it's closed and removes the file.
+     * All the bars publishing to it should be gone by now.
+     */
+    ~SharedExport() override;
+
+    SharedExport(SharedExport const &) = delete;
+    SharedExport &operator=(SharedExport const &) = delete;
+    SharedExport(SharedExport &&) = delete;
+    SharedExport &operator=(SharedExport &&) = delete;
+
+    /**
+     * @brief /dev/shm/progress.<pid>
+     *
+     * @return std::string
+     */
+    static std::string default_path() { return "/dev/shm/progress." + std::to_string(::getpid()); }
+
+    /**
+     * @brief the file, to hand to the reader.
+     *
+     * @return const std::string&
+     */
+    const std::string &path() const { return m_path; }
+
+    /**
+     * @brief claims a free record, or one of a finished bar if there are none left.
+     *
+     * @throws std::length_error if all the records belong to live bars
+     */
+    std::size_t attach(std::string_view name, int64_t total) override;
+
+    void count(std::size_t slot, int64_t counter) override {
+        detail::SharedRecord &record = m_records[slot];
+        record.count.store(counter, std::memory_order_relaxed);
+        record.update_ns.store(detail::shared_now(), std::memory_order_relaxed);
+    }
+
+    void detach(std::size_t slot, int64_t counter) override;
+
+private:
+    std::string m_path;
+    uint32_t m_capacity;
+    void *m_mapping{nullptr};
+    detail::SharedHeader *m_header{nullptr};
+    detail::SharedRecord *m_records{nullptr};
+};
+
+/**
+ * @brief One bar as the reader sees it.
+ */
+struct SharedBar {
+    std::string name;
+    int64_t count;
+    // unknown_total if unknown
+    int64_t total;
+    std::chrono::system_clock::time_point start;
+    std::chrono::system_clock::time_point update;
+    bool done;
+};
+
+/**
+ * @brief The reading side, maps a SharedExport's file read only.
+ */
+class SharedReader {
+public:
+    /**
+     * @brief Map the file.
+     *
+     * @param path the path of the SharedExport
+     * @throws std::system_error if it can't be opened, std::runtime_error if it isn't one
+     */
+    explicit SharedReader(const std::string &path);
+
+    ~SharedReader() { ::munmap(m_mapping, m_size); }
+
+    SharedReader(SharedReader const &) = delete;
+    SharedReader &operator=(SharedReader const &) = delete;
+    SharedReader(SharedReader &&) = delete;
+    SharedReader &operator=(SharedReader &&) = delete;
+
+    /**
+     * @brief the bars that are live or done, in record order. Reuses the strings in bars.
+     *
+     * @param bars filled with the bars
+     */
+    void read(std::vector<SharedBar> &bars) const;
+
+    /**
+     * @brief whether the SharedExport is gone.
+     */
+    bool closed() const { return m_header->closed.load(std::memory_order_acquire) != 0; }
+
+private:
+    void *m_mapping{nullptr};
+    std::size_t m_size{};
+    const detail::SharedHeader *m_header{nullptr};
+    const detail::SharedRecord *m_records{nullptr};
+};
+
+inline SharedExport::SharedExport(std::string path, uint32_t capacity)
+    : m_path(std::move(path)), m_capacity(capacity) {
+    int fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "progress: " + m_path);
+    }
+    std::size_t size = detail::shared_size(m_capacity);
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "progress: " + m_path);
+    }
+    m_mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (m_mapping == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), "progress: " + m_path);
+    }
+    // a fresh file is all zeros, which is a valid state for all the atomics
+    m_header = new (m_mapping) detail::SharedHeader{};
+    m_records = reinterpret_cast<detail::SharedRecord *>(m_header + 1);
+    for (uint32_t i = 0; i < m_capacity; i++) {
+        new (&m_records[i]) detail::SharedRecord{};
+    }
+    m_header->magic = detail::shared_magic;
+    m_header->version = detail::shared_version;
+    m_header->capacity = m_capacity;
+}
+
+inline SharedExport::~SharedExport() {
+    m_header->closed.store(1, std::memory_order_release);
+    ::munmap(m_mapping, detail::shared_size(m_capacity));
+    ::unlink(m_path.c_str());
+}
+
+inline std::size_t SharedExport::attach(std::string_view name, int64_t total) {
+    for (uint32_t from : {detail::free_record, detail::done_record}) {
+        for (uint32_t i = 0; i < m_capacity; i++) {
+            detail::SharedRecord &record = m_records[i];
+            uint32_t state = from;
+            if (!record.state.compare_exchange_strong(state, detail::claiming_record,
+                                                      std::memory_order_acquire)) {
+                continue;
+            }
+            std::size_t length = std::min(name.size(), sizeof(record.name) - 1);
+            std::memcpy(record.name, name.data(), length);
+            record.name[length] = '\0';
+            int64_t now = detail::shared_now();
+            record.count.store(0, std::memory_order_relaxed);
+            record.total.store(total, std::memory_order_relaxed);
+            record.start_ns.store(now, std::memory_order_relaxed);
+            record.update_ns.store(now, std::memory_order_relaxed);
+            record.state.store(detail::live_record, std::memory_order_release);
+            return i;
+        }
+    }
+    throw std::length_error("progress: SharedExport " + m_path + " is full");
+}
+
+inline void SharedExport::detach(std::size_t slot, int64_t counter) {
+    count(slot, counter);
+    m_records[slot].state.store(detail::done_record, std::memory_order_release);
+}
+
+inline SharedReader::SharedReader(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "progress: " + path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 ||
+        static_cast<std::size_t>(info.st_size) < sizeof(detail::SharedHeader)) {
+        ::close(fd);
+        throw std::runtime_error("progress: " + path + " isn't a progress export");
+    }
+    m_size = static_cast<std::size_t>(info.st_size);
+    m_mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (m_mapping == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), "progress: " + path);
+    }
+    m_header = static_cast<const detail::SharedHeader *>(m_mapping);
+    m_records = reinterpret_cast<const detail::SharedRecord *>(m_header + 1);
+    if (m_header->magic != detail::shared_magic || m_header->version != detail::shared_version ||
+        detail::shared_size(m_header->capacity) > m_size) {
+        ::munmap(m_mapping, m_size);
+        throw std::runtime_error("progress: " + path + " isn't a progress export");
+    }
+}
+
+inline void SharedReader::read(std::vector<SharedBar> &bars) const {
+    using std::chrono::nanoseconds;
+    using std::chrono::system_clock;
+    std::size_t found = 0;
+    for (uint32_t i = 0; i < m_header->capacity; i++) {
+        const detail::SharedRecord &record = m_records[i];
+        uint32_t state = record.state.load(std::memory_order_acquire);
+        if (state != detail::live_record && state != detail::done_record) {
+            continue;
+        }
+        if (found == bars.size()) {
+            bars.emplace_back();
+        }
+        SharedBar &bar = bars[found];
+        bar.name.assign(record.name, ::strnlen(record.name, sizeof(record.name)));
+        bar.count = record.count.load(std::memory_order_relaxed);
+        bar.total = record.total.load(std::memory_order_relaxed);
+        bar.start = system_clock::time_point(std::chrono::duration_cast<system_clock::duration>(
+            nanoseconds(record.start_ns.load(std::memory_order_relaxed))));
+        bar.update = system_clock::time_point(std::chrono::duration_cast<system_clock::duration>(
+            nanoseconds(record.update_ns.load(std::memory_order_relaxed))));
+        // the record got reclaimed by a new bar while this read it, skip it this round
+        uint32_t after = record.state.load(std::memory_order_acquire);
+        if (after != detail::live_record && after != detail::done_record) {
+            continue;
+        }
+        bar.done = after == detail::done_record;
+        found++;
+    }
+    bars.resize(found);
+}
+}  // namespace progress
@@ -0,0 +1,197 @@
+// A Progress configured at compile time, so the columns you don't want aren't even compiled.
+//
+//     constexpr progress::Config quiet{.bar_length = 0, .show_eta = false};
+//     for (progress::StaticProgress<quiet> bar(limit); auto i : bar) { ... }
+//
+// The counter lives in the iterator, so the loop is the same as a plain for loop plus one compare
+// against the next tick. StaticProgress<progress::null> (or any config, if PROGRESS_DISABLE is
+// defined) doesn't even have that, it is the plain for loop.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "progress.hpp"
+
+namespace progress {
+
+#if defined(PROGRESS_DISABLE)
+inline constexpr bool enabled_by_default = false;
+#else
+inline constexpr bool enabled_by_default = true;
+#endif
+
+/**
+ * @brief What StaticProgress shows. Everything is known at compile time, so a column that's off
+ * costs nothing.
+ */
+struct Config {
+    // false turns the whole bar into a plain loop. Defaults to false when PROGRESS_DISABLE is
+    // defined
+    bool enabled{enabled_by_default};
+    // number of prints over the whole loop, 0 for every increment
+    int64_t ticks{100};
+    // characters in the bar, 0 for no bar
+    int bar_length{20};
+    // opening, done, remaining and closing character
+    char style[4]{'[', '#', ' ', ']'};
+    bool show_percent{true};
+    bool show_elapsed{true};
+    bool show_eta{true};
+    // print the time taken in the destructor
+    bool show_summary{true};
+};
+
+/**
+ * @brief no output, no clock, nothing. The range-for is a plain for loop.
+ */
+inline constexpr Config null{.enabled = false};
+
+template <Config C = Config{}>
+class StaticProgress {
+public:
+    struct Sentinel {};
+
+    struct Iterator {
+        int64_t operator*() const { return m_counter; }
+
+        Iterator &operator++() {
+            ++m_counter;
+            if constexpr (C.enabled) {
+                if (m_counter >= m_bar->m_next_threshold) [[unlikely]] {
+                    m_bar->render(m_counter);
+                }
+            }
+            return *this;
+        }
+
+        friend bool operator!=(const Iterator &it, Sentinel) { return it.m_counter < it.m_total; }
+
+        int64_t m_counter;
+        // a copy, so the loop condition doesn't go through m_bar
+        int64_t m_total;
+        StaticProgress *m_bar;
+    };
+
+    /**
+     * @brief Construct a new StaticProgress object
+     *
+     * @param total Number of increments. max counter value will be total - 1
+     * @param ostream std::ostream object to write to
+     */
+    explicit StaticProgress(int64_t total, std::ostream &ostream = std::cout)
+        : m_total(total), m_output(ostream) {
+        if constexpr (C.enabled) {
+            size_line();
+            m_start = std::chrono::high_resolution_clock::now();
+        }
+    }
+
+    /**
+     * @brief Destroy the StaticProgress object. Prints a new line and, with show_summary, the time
+     * taken.
+     */
+    ~StaticProgress() {
+        if constexpr (C.enabled) {
+            m_output << std::endl;
+            if constexpr (C.show_summary) {
+                auto finish = std::chrono::high_resolution_clock::now();
+                m_output << m_name << " took "
+                         << std::chrono::duration_cast<std::chrono::seconds>(finish - m_start)
+                                .count()
+                         << " seconds." << std::endl;
+            }
+        }
+    }
+
+    StaticProgress(StaticProgress const &) = delete;
+    StaticProgress &operator=(StaticProgress const &) = delete;
+    StaticProgress(StaticProgress &&) = delete;
+    StaticProgress &operator=(StaticProgress &&) = delete;
+
+    Iterator begin() { return {0, m_total, this}; }
+    Sentinel end() { return {}; }
+
+    /**
+     * @brief the name of the bar. Printed first to the left of the line.
+     *
+     * @param name string. whatever you want.
+     * @return StaticProgress&
+     */
+    StaticProgress &name(std::string_view name) {
+        if constexpr (C.enabled) {
+            m_name = name;
+            size_line();
+        }
+        return *this;
+    }
+
+private:
+    void size_line() {
+        constexpr std::string_view fixed = "  : []  /  % Elapsed:  ET: \r";
+        m_line.resize(m_name.size() + fixed.size() + static_cast<std::size_t>(C.bar_length) +
+                      3 * detail::max_int_chars + 2 * detail::max_duration_chars);
+    }
+
+    int64_t ticks() const { return C.ticks > 0 ? C.ticks : m_total; }
+
+    PROGRESS_NOINLINE void render(int64_t counter) {
+        int64_t current_tick = detail::muldiv(counter, ticks(), m_total);
+        m_next_threshold = detail::muldiv_ceil(current_tick + 1, m_total, ticks());
+
+        char *out = m_line.data();
+        out = detail::append(out, ' ');
+        out = detail::append(out, m_name);
+        out = detail::append(out, " : ");
+        if constexpr (C.bar_length > 0) {
+            int64_t filled = detail::muldiv(current_tick, C.bar_length, ticks());
+            auto done = static_cast<std::size_t>(std::clamp<int64_t>(filled, 0, C.bar_length));
+            out = detail::append(out, C.style[0]);
+            std::memset(out, C.style[1], done);
+            std::memset(out + done, C.style[2], static_cast<std::size_t>(C.bar_length) - done);
+            out += C.bar_length;
+            out = detail::append(out, C.style[3]);
+            out = detail::append(out, ' ');
+        }
+        out = detail::append(out, counter);
+        out = detail::append(out, " / ");
+        out = detail::append(out, m_total);
+        if constexpr (C.show_percent) {
+            out = detail::append(out, ' ');
+            out = detail::append(out, detail::muldiv(current_tick, 100, ticks()), 4);
+            out = detail::append(out, '%');
+        }
+        if constexpr (C.show_elapsed || C.show_eta) {
+            auto elapsed = std::chrono::high_resolution_clock::now() - m_start;
+            if constexpr (C.show_elapsed) {
+                out = detail::append(out, " Elapsed: ");
+                out = detail::append(out, elapsed);
+            }
+            if constexpr (C.show_eta) {
+                out = detail::append(out, " ET: ");
+                out = detail::append(out, std::chrono::high_resolution_clock::duration(
+                                              detail::muldiv(elapsed.count(), m_total, counter)));
+            }
+        }
+        out = detail::append(out, '\r');
+        m_output.write(m_line.data(), out - m_line.data());
+        m_output.flush();
+    }
+
+    int64_t m_total;
+    // first counter value that prints. 1, so that the first increment prints
+    int64_t m_next_threshold{1};
+    std::string m_name{"Progress"};
+    std::string m_line;
+    std::ostream &m_output;
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_start;
+};
+}  // namespace progress
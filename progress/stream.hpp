@@ -0,0 +1,109 @@
+// Byte progress for streaming input.
+//
+//     std::ifstream file(path, std::ios::binary);
+//     progress::ProgressIstream in(file, file_size);
+//     while (in.read(buffer, size)) { ... }
+//
+// ProgressStreambuf sits in front of another streambuf and adds the bytes handed out to a bar.
+// It has no buffer of its own: bulk reads go straight from the source into the caller's buffer,
+// single characters are passed through one at a time.
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <utility>
+
+#include "progress.hpp"
+
+namespace progress {
+
+class ProgressStreambuf : public std::streambuf {
+public:
+    /**
+     * @brief Construct a new ProgressStreambuf object
+     *
+     * @param source where the bytes come from
+     * @param bar the bar to add() the bytes to, set it up with bytes() and a total
+     */
+    ProgressStreambuf(std::streambuf *source, Progress &bar) : m_source(source), m_bar(bar) {}
+
+protected:
+    int_type underflow() override { return m_source->sgetc(); }
+
+    int_type uflow() override {
+        int_type c = m_source->sbumpc();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            m_bar.add(1);
+        }
+        return c;
+    }
+
+    std::streamsize xsgetn(char_type *s, std::streamsize count) override {
+        std::streamsize got = m_source->sgetn(s, count);
+        m_bar.add(got);
+        return got;
+    }
+
+    std::streamsize showmanyc() override { return m_source->in_avail(); }
+
+private:
+    std::streambuf *m_source;
+    Progress &m_bar;
+};
+
+/**
+ * @brief An istream reading from another istream and showing a byte bar while doing so.
+ */
+class ProgressIstream : public std::istream {
+public:
+    /**
+     * @brief Construct a new ProgressIstream object
+     *
+     * @param source where the bytes come from
+     * @param total number of bytes that will be read, or unknown_total
+     * @param ostream std::ostream object to write the bar to
+     */
+    ProgressIstream(std::istream &source, int64_t total, std::ostream &ostream = std::cout)
+        : std::istream(nullptr), m_bar(total, ostream), m_buffer(source.rdbuf(), m_bar) {
+        m_bar.bytes();
+        rdbuf(&m_buffer);
+    }
+
+    /**
+     * @brief the bar, for the named parameters
+     *
+     * @return Progress&
+     */
+    Progress &bar() { return m_bar; }
+
+private:
+    Progress m_bar;
+    ProgressStreambuf m_buffer;
+};
+
+/**
+ * @brief Wrap a read callback, e.g. around ::read() or fread(), so that whatever it returns is
+ * added to the bar. The data itself isn't touched.
+ *
+ *     auto read = progress::count_reads(
+ *         bar, [&](char *buf, size_t n) { return ::read(fd, buf, n); });
+ *     while (read(buffer, sizeof(buffer)) > 0) { ... }
+ *
+ * @param bar the bar to add() the bytes to
+ * @param read callback returning the number of bytes read. Negative return values aren't counted
+ * @return a callable with the same arguments and result as read
+ */
+template <typename Read>
+auto count_reads(Progress &bar, Read read) {
+    return [&bar, read = std::move(read)](auto &&...args) mutable {
+        auto got = read(std::forward<decltype(args)>(args)...);
+        if (got > 0) {
+            bar.add(static_cast<int64_t>(got));
+        }
+        return got;
+    };
+}
+}  // namespace progress
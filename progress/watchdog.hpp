@@ -0,0 +1,239 @@
+// Notices when a loop hangs or slows down, instead of the bar just sitting there.
+//
+//     progress::Progress bar(limit);
+//     progress::Watchdog watchdog(bar, {.deadline = std::chrono::minutes(5)});
+//     for (auto i : bar) { ... }
+//
+// A thread of the watchdog's own reads the counter of the bar every poll, the loop does nothing it
+// didn't do before. When the counter doesn't move for deadline, or the rate since the last poll
+// drops below slowdown times the smoothed rate, the callback is called and a line starting with
+// "!!" goes to the ostream, with the time the counter last moved. Each stall or slowdown is
+// reported once, and again only after the loop recovered. The total and the name of the bar are
+// read once, when the watchdog starts, only the counter is read from the thread.
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "progress.hpp"
+
+namespace progress {
+
+/**
+ * @brief What a Watchdog looks for.
+ */
+struct WatchdogConfig {
+    // no progress for this long is a stall. Zero turns it off
+    std::chrono::nanoseconds deadline{std::chrono::seconds(60)};
+    // a rate below this fraction of the smoothed rate is a slowdown. Zero turns it off
+    double slowdown{0.1};
+    // how long the smoothed rate remembers. No slowdown is reported before this much time passed
+    std::chrono::nanoseconds half_life{std::chrono::seconds(30)};
+    // time between two looks at the counter. Zero for no thread, call Watchdog::check() yourself
+    std::chrono::milliseconds poll{std::chrono::seconds(1)};
+    // print the "!!" line
+    bool print{true};
+    // where the time comes from, e.g. a fake one for tests
+    Clock clock{default_clock};
+};
+
+enum class Alarm { stall, slowdown };
+
+/**
+ * @brief What the Watchdog callback gets.
+ */
+struct WatchdogEvent {
+    Alarm alarm;
+    int64_t count;
+    // when the counter last moved
+    std::chrono::time_point<std::chrono::high_resolution_clock> last_progress;
+    // the rate since the previous poll and the smoothed rate, per second
+    double rate;
+    double smoothed;
+};
+
+class Watchdog {
+public:
+    using Callback = std::function<void(const WatchdogEvent &)>;
+
+    /**
+     * @brief Start watching bar. The watchdog has to go before the bar does, so declare it after.
+     *
+     * @param bar the bar to watch. For a ConcurrentProgress its bar(), which only moves on its
+     * ticks, so the deadline has to be longer than a tick takes. Its total and name are copied
+     * here, changing them later doesn't reach the watchdog
+     * @param config the limits
+     * @param callback called from the watchdog thread on every alarm, may be empty
+     * @param ostream where the "!!" lines go. Not the ostream of the bar, the two threads would
+     * write to it at the same time
+     */
+    explicit Watchdog(const Progress &bar, WatchdogConfig config = {}, Callback callback = {},
+                      std::ostream &ostream = std::cerr);
+
+    /**
+     * @brief Destroy the Watchdog object. Stops and joins the thread.
+     */
+    ~Watchdog();
+
+    Watchdog(Watchdog const &) = delete;
+    Watchdog &operator=(Watchdog const &) = delete;
+    Watchdog(Watchdog &&) = delete;
+    Watchdog &operator=(Watchdog &&) = delete;
+
+    /**
+     * @brief Look at the counter now. The thread calls this every poll, without a thread it's up to
+     * you. Not thread safe, only one of the two may call it.
+     *
+     * @return true if an alarm went off
+     */
+    bool check();
+
+private:
+    void raise(Alarm alarm, int64_t count, double rate,
+               std::chrono::time_point<std::chrono::high_resolution_clock> now);
+
+    const Progress &m_bar;
+    // copies, the thread can't read them while the bar's thread may set them
+    int64_t m_total;
+    std::string m_name;
+    WatchdogConfig m_config;
+    Callback m_callback;
+    std::ostream &m_output;
+
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_start;
+    // the previous check()
+    int64_t m_count{};
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_time;
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_last_progress;
+    // per second, negative until the first rate came in
+    double m_smoothed{-1};
+    // reported and not recovered yet
+    bool m_stalled{false};
+    bool m_slow{false};
+
+    bool m_stop{false};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+};
+
+inline Watchdog::Watchdog(const Progress &bar, WatchdogConfig config, Callback callback,
+                          std::ostream &ostream)
+    : m_bar(bar), m_total(bar.total()), m_name(bar.name()), m_config(config),
+      m_callback(std::move(callback)), m_output(ostream) {
+    m_start = m_config.clock();
+    m_time = m_start;
+    m_last_progress = m_start;
+    m_count = m_bar.count();
+    if (m_config.poll.count() > 0) {
+        m_thread = std::thread([this] {
+            std::unique_lock lock(m_mutex);
+            while (!m_wake.wait_for(lock, m_config.poll, [this] { return m_stop; })) {
+                check();
+            }
+        });
+    }
+}
+
+inline Watchdog::~Watchdog() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+}
+
+inline bool Watchdog::check() {
+    auto now = m_config.clock();
+    int64_t count = m_bar.count();
+    double seconds = std::chrono::duration<double>(now - m_time).count();
+    int64_t counted = count - m_count;
+    m_count = count;
+    m_time = now;
+    if (m_total != unknown_total && count >= m_total) {
+        // done, nothing left to hang
+        return false;
+    }
+
+    bool raised = false;
+    if (counted != 0) {
+        m_last_progress = now;
+        m_stalled = false;
+    } else if (!m_stalled && m_config.deadline.count() > 0 &&
+               now - m_last_progress >= m_config.deadline) {
+        m_stalled = true;
+        raise(Alarm::stall, count, 0., now);
+        raised = true;
+    }
+
+    // a poll without progress is the deadline's business, with lumpy progress it's also normal
+    if (counted <= 0 || seconds <= 0) {
+        return raised;
+    }
+    double rate = static_cast<double>(counted) / seconds;
+    if (m_smoothed >= 0 && m_config.slowdown > 0 && now - m_start >= m_config.half_life) {
+        if (rate < m_config.slowdown * m_smoothed) {
+            if (!m_slow) {
+                m_slow = true;
+                raise(Alarm::slowdown, count, rate, now);
+                raised = true;
+            }
+        } else {
+            m_slow = false;
+        }
+    }
+    // an ewma over time, not over polls, so it doesn't matter how regular they are
+    double half_lives = seconds / std::chrono::duration<double>(m_config.half_life).count();
+    double alpha = m_smoothed < 0 ? 1. : 1. - std::exp2(-half_lives);
+    m_smoothed = m_smoothed < 0 ? rate : m_smoothed + alpha * (rate - m_smoothed);
+    return raised;
+}
+
+inline void Watchdog::raise(Alarm alarm, int64_t count, double rate,
+                            std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+    WatchdogEvent event{alarm, count, m_last_progress, rate, m_smoothed};
+    if (m_callback) {
+        m_callback(event);
+    }
+    if (!m_config.print) {
+        return;
+    }
+    // "\n!! <name> stalled, no progress for <t>, last at <t> with <count>\n"
+    // "\n!! <name> slowed down to <rate>/s from <rate>/s, last progress at <t> with <count>\n"
+    std::string line(m_name.size() + 64 + 3 * format::max_chars + 2 * detail::max_duration_chars,
+                     ' ');
+    char *out = line.data();
+    // on its own line, not over the '\r' line of the bar
+    out = detail::append(out, "\n!! ");
+    out = detail::append(out, m_name);
+    if (alarm == Alarm::stall) {
+        out = detail::append(out, " stalled, no progress for ");
+        out = detail::append(out, now - m_last_progress);
+        out = detail::append(out, ", last at ");
+    } else {
+        out = detail::append(out, " slowed down to ");
+        out = format::count(out, static_cast<int64_t>(rate));
+        out = detail::append(out, "/s from ");
+        out = format::count(out, static_cast<int64_t>(m_smoothed));
+        out = detail::append(out, "/s, last progress at ");
+    }
+    out = detail::append(out, m_last_progress - m_start);
+    out = detail::append(out, " with ");
+    out = format::count(out, count);
+    out = detail::append(out, '\n');
+    m_output.write(line.data(), out - line.data());
+    m_output.flush();
+}
+}  // namespace progress
@@ -0,0 +1,275 @@
+// A bar around any range, not just a counter.
+//
+//     for (auto &record : progress::wrap(records)) { ... }
+//     for (auto x : records | progress::wrap | std::views::transform(f)) { ... }
+//
+// The iterator is the range's own iterator plus a push() on every increment. Sized ranges give the
+// bar its total, anything else (like an istream view) gets a bar with an unknown total.
+//
+// When the elements cost very different amounts of work, e.g. files of a few bytes to a few
+// gigabytes, weigh them. The bar then counts weight, so percentage, fill and ETA follow the work:
+//
+//     for (auto &file : progress::weighted(files, [](auto &f) { return f.size; })) { ... }
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <ranges>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "progress.hpp"
+
+namespace progress {
+
+namespace detail {
+// every element weighs 1, i.e. a plain push()
+struct UnitWeight {};
+}  // namespace detail
+
+template <std::ranges::view V, typename Weight = detail::UnitWeight>
+class ProgressView : public std::ranges::view_interface<ProgressView<V, Weight>> {
+    static constexpr bool weighted = !std::is_same_v<Weight, detail::UnitWeight>;
+
+public:
+    class Iterator;
+    class Sentinel;
+
+    ProgressView() = default;
+
+    /**
+     * @brief Construct a new ProgressView object. The bar is created here, so the clock starts
+     * now.
+     *
+     * @param base the range to go through
+     * @param ostream std::ostream object to write to
+     */
+    explicit ProgressView(V base, std::ostream &ostream = std::cout)
+        requires(!weighted)
+        : m_base(std::move(base)),
+          m_shared(std::make_shared<Shared>(total_of(m_base), ostream, Weight{})) {}
+
+    /**
+     * @brief Construct a new weighted ProgressView object, with the total weight known up front.
+     *
+     * @param base the range to go through
+     * @param weight int64_t weight(element), how much of the total an element is
+     * @param total sum of the weights of all the elements
+     * @param ostream std::ostream object to write to
+     */
+    ProgressView(V base, Weight weight, int64_t total, std::ostream &ostream = std::cout)
+        requires weighted
+        : m_base(std::move(base)),
+          m_shared(std::make_shared<Shared>(total, ostream, std::move(weight))) {}
+
+    /**
+     * @brief Construct a new weighted ProgressView object. The total weight is summed up here,
+     * which goes through the range once before the loop does.
+     *
+     * @param base the range to go through
+     * @param weight int64_t weight(element), how much of the total an element is
+     * @param ostream std::ostream object to write to
+     */
+    ProgressView(V base, Weight weight, std::ostream &ostream = std::cout)
+        requires weighted && std::ranges::forward_range<V>
+        : m_base(std::move(base)),
+          m_shared(std::make_shared<Shared>(weigh(m_base, weight), ostream, std::move(weight))) {}
+
+    /**
+     * @brief the bar, for the named parameters. Set them before the loop starts.
+     *
+     * @return Progress&
+     */
+    Progress &bar() const { return m_shared->bar; }
+
+    V base() const &
+        requires std::copy_constructible<V>
+    {
+        return m_base;
+    }
+    V base() && { return std::move(m_base); }
+
+    Iterator begin() { return Iterator(std::ranges::begin(m_base), m_shared.get()); }
+    Sentinel end() { return Sentinel(std::ranges::end(m_base)); }
+
+    auto size()
+        requires std::ranges::sized_range<V>
+    {
+        return std::ranges::size(m_base);
+    }
+
+private:
+    // shared, since views get copied around but the bar can't move. The weight goes with it, a
+    // lambda can't be assigned
+    struct Shared {
+        Shared(int64_t total, std::ostream &ostream, Weight weight_)
+            : bar(total, ostream), weight(std::move(weight_)) {}
+
+        Progress bar;
+        [[no_unique_address]] Weight weight;
+    };
+
+    static int64_t total_of(V &base) {
+        if constexpr (std::ranges::sized_range<V>) {
+            return static_cast<int64_t>(std::ranges::size(base));
+        } else {
+            return unknown_total;
+        }
+    }
+
+    static int64_t weigh(V &base, Weight &weight) {
+        int64_t total = 0;
+        for (auto &&element : base) {
+            total += static_cast<int64_t>(weight(element));
+        }
+        return total;
+    }
+
+    V m_base{};
+    std::shared_ptr<Shared> m_shared;
+};
+
+/**
+ * @brief The iterator of the range, and a push() to the bar on every ++, or an add() of the
+ * element's weight. An input iterator only, since going through the range twice would count
+ * everything twice.
+ */
+template <std::ranges::view V, typename Weight>
+class ProgressView<V, Weight>::Iterator {
+public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type = std::ranges::range_value_t<V>;
+    using difference_type = std::ranges::range_difference_t<V>;
+
+    Iterator() = default;
+    Iterator(std::ranges::iterator_t<V> current, Shared *shared)
+        : m_current(std::move(current)), m_shared(shared) {}
+
+    decltype(auto) operator*() const { return *m_current; }
+
+    Iterator &operator++() {
+        if constexpr (weighted) {
+            // weighed before the ++, an input range's element is gone after it
+            auto weight = static_cast<int64_t>(m_shared->weight(*m_current));
+            ++m_current;
+            m_shared->bar.add(weight);
+        } else {
+            ++m_current;
+            m_shared->bar.push();
+        }
+        return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    const std::ranges::iterator_t<V> &base() const & { return m_current; }
+
+private:
+    std::ranges::iterator_t<V> m_current{};
+    Shared *m_shared{nullptr};
+};
+
+template <std::ranges::view V, typename Weight>
+class ProgressView<V, Weight>::Sentinel {
+public:
+    Sentinel() = default;
+    explicit Sentinel(std::ranges::sentinel_t<V> end) : m_end(std::move(end)) {}
+
+    friend bool operator==(const Iterator &it, const Sentinel &sentinel) {
+        return it.base() == sentinel.m_end;
+    }
+
+private:
+    std::ranges::sentinel_t<V> m_end{};
+};
+
+template <typename R>
+ProgressView(R &&) -> ProgressView<std::views::all_t<R>>;
+template <typename R>
+ProgressView(R &&, std::ostream &) -> ProgressView<std::views::all_t<R>>;
+template <typename R, typename Weight>
+ProgressView(R &&, Weight, int64_t) -> ProgressView<std::views::all_t<R>, Weight>;
+template <typename R, typename Weight>
+ProgressView(R &&, Weight, int64_t, std::ostream &) -> ProgressView<std::views::all_t<R>, Weight>;
+template <typename R, typename Weight>
+ProgressView(R &&, Weight) -> ProgressView<std::views::all_t<R>, Weight>;
+template <typename R, typename Weight>
+ProgressView(R &&, Weight, std::ostream &) -> ProgressView<std::views::all_t<R>, Weight>;
+
+namespace detail {
+struct Wrap {
+    /**
+     * @brief wrap a range in a bar
+     *
+     * @param range anything std::views::all takes, a container, a view, ...
+     * @return ProgressView
+     */
+    template <std::ranges::viewable_range R>
+    auto operator()(R &&range) const {
+        return ProgressView(std::forward<R>(range));
+    }
+
+    /**
+     * @brief wrap a range in a bar with a name
+     *
+     * @param range anything std::views::all takes, a container, a view, ...
+     * @param name the name of the bar
+     * @param ostream std::ostream object to write to
+     * @return ProgressView
+     */
+    template <std::ranges::viewable_range R>
+    auto operator()(R &&range, std::string_view name, std::ostream &ostream = std::cout) const {
+        auto view = ProgressView(std::forward<R>(range), ostream);
+        view.bar().name(name);
+        return view;
+    }
+
+    // so that range | progress::wrap works too
+    template <std::ranges::viewable_range R>
+    friend auto operator|(R &&range, const Wrap &wrap) {
+        return wrap(std::forward<R>(range));
+    }
+};
+}  // namespace detail
+
+/**
+ * @brief wrap(range), wrap(range, name) or range | wrap. See the top of the file.
+ */
+inline constexpr detail::Wrap wrap{};
+
+/**
+ * @brief wrap a range in a bar that advances by weight(element) per element instead of 1. The
+ * total is the sum of all the weights, so the range is gone through once up front.
+ *
+ * @param range a forward range, anything std::views::all takes
+ * @param weight int64_t weight(element), e.g. the size of a file
+ * @param ostream std::ostream object to write to
+ * @return ProgressView
+ */
+template <std::ranges::viewable_range R, typename Weight>
+    requires std::ranges::forward_range<R>
+auto weighted(R &&range, Weight weight, std::ostream &ostream = std::cout) {
+    return ProgressView<std::views::all_t<R>, Weight>(std::views::all(std::forward<R>(range)),
+                                                      std::move(weight), ostream);
+}
+
+/**
+ * @brief wrap a range in a bar that advances by weight(element) per element, with the sum of the
+ * weights known up front. Works for input ranges too.
+ *
+ * @param range anything std::views::all takes
+ * @param weight int64_t weight(element), e.g. the size of a file
+ * @param total sum of all the weights
+ * @param ostream std::ostream object to write to
+ * @return ProgressView
+ */
+template <std::ranges::viewable_range R, typename Weight>
+auto weighted(R &&range, Weight weight, int64_t total, std::ostream &ostream = std::cout) {
+    return ProgressView<std::views::all_t<R>, Weight>(std::views::all(std::forward<R>(range)),
+                                                      std::move(weight), total, ostream);
+}
+
+}  // namespace progress
@@ -0,0 +1,59 @@
+// a few macros instead of a test framework. Every TEST() is a function the runner in main.cpp
+// calls by name, a failed CHECK() prints where and marks the test failed
+#pragma once
+
+#include <iostream>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+
+namespace test {
+
+struct Case {
+    std::string_view name;
+    void (*fn)();
+};
+
+inline std::vector<Case> &cases() {
+    static std::vector<Case> all;
+    return all;
+}
+
+inline bool failed = false;
+
+struct Register {
+    Register(std::string_view name, void (*fn)()) { cases().push_back({name, fn}); }
+};
+
+// swallows everything, like bench::NullBuffer
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+}  // namespace test
+
+#define TEST(name)                                                   \
+    static void test_##name();                                       \
+    static const test::Register register_##name(#name, test_##name); \
+    static void test_##name()
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            test::failed = true;                                                            \
+        }                                                                                   \
+    } while (false)
+
+#define CHECK_EQ(left, right)                                                           \
+    do {                                                                                \
+        auto &&left_ = (left);                                                          \
+        auto &&right_ = (right);                                                        \
+        if (!(left_ == right_)) {                                                       \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK_EQ(" #left ", " #right \
+                      << ") failed, " << left_ << " != " << right_ << '\n';             \
+            test::failed = true;                                                        \
+        }                                                                               \
+    } while (false)
@@ -0,0 +1,26 @@
+// runs the test named on the command line, or all of them
+
+#include <iostream>
+#include <string_view>
+
+#include "check.hpp"
+
+int main(int argc, char **argv) {
+    bool found = false;
+    for (const test::Case &c : test::cases()) {
+        if (argc > 1 && c.name != argv[1]) {
+            continue;
+        }
+        found = true;
+        c.fn();
+        std::cout << (test::failed ? "FAILED " : "ok ") << c.name << std::endl;
+        if (test::failed) {
+            return 1;
+        }
+    }
+    if (!found) {
+        std::cerr << "no test called " << argv[1] << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+// push() and add() don't allocate once the bar is constructed, renders included
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+
+#include "check.hpp"
+#include "progress.hpp"
+
+namespace {
+std::atomic<int64_t> allocations{0};
+}  // namespace
+
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// a loop of pushes and adds that renders about 2000 times
+void run(progress::Progress &bar) {
+    int64_t before = allocations.load(std::memory_order_relaxed);
+    for (int64_t i = 0; i < 500'000; i++) {
+        bar.push();
+    }
+    for (int64_t i = 0; i < 250'000; i++) {
+        bar.add(2);
+    }
+    CHECK_EQ(allocations.load(std::memory_order_relaxed) - before, 0);
+}
+
+}  // namespace
+
+TEST(alloc_terminal) {
+    test::NullBuffer null;
+    std::ostream stream(&null);
+    progress::Progress bar(1'000'000, 2000, stream);
+    bar.output(progress::Output::terminal).show_rate(true);
+    run(bar);
+}
+
+TEST(alloc_full_line) {
+    test::NullBuffer null;
+    std::ostream stream(&null);
+    progress::Progress bar(1'000'000, 2000, stream);
+    bar.output(progress::Output::terminal).differential(false).style(progress::eighth_blocks);
+    run(bar);
+}
+
+TEST(alloc_log) {
+    test::NullBuffer null;
+    std::ostream stream(&null);
+    progress::Progress bar(1'000'000, 2000, stream);
+    bar.output(progress::Output::log).min_interval(std::chrono::seconds(0));
+    run(bar);
+}
+
+TEST(alloc_json) {
+    test::NullBuffer null;
+    std::ostream stream(&null);
+    progress::Progress bar(1'000'000, 2000, stream);
+    bar.output(progress::Output::json).min_interval(std::chrono::seconds(0));
+    run(bar);
+}
@@ -0,0 +1,126 @@
+// differential() sends a fraction of the bytes of full lines, and what ends up on the terminal is
+// the same
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "check.hpp"
+#include "progress.hpp"
+
+namespace {
+
+// counts what goes through it, like the one of bench_redraw
+class CountingBuffer : public std::streambuf {
+public:
+    int64_t bytes{0};
+    std::string text;
+
+protected:
+    int overflow(int c) override {
+        bytes++;
+        text.push_back(static_cast<char>(c));
+        return c;
+    }
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        bytes += n;
+        text.append(s, static_cast<std::size_t>(n));
+        return n;
+    }
+};
+
+// a clock that moves by 1ms a read, so both runs print the same times
+std::chrono::time_point<std::chrono::high_resolution_clock> fake_now;
+
+std::chrono::time_point<std::chrono::high_resolution_clock> fake_clock() {
+    fake_now += std::chrono::milliseconds(1);
+    return fake_now;
+}
+
+struct Run {
+    int64_t bytes;
+    std::string text;
+};
+
+Run run(bool differential, std::string_view style) {
+    fake_now = {};
+    CountingBuffer counting;
+    std::ostream stream(&counting);
+    {
+        progress::Progress bar(100'000, 1000, stream);
+        bar.clock(fake_clock).output(progress::Output::terminal).differential(differential);
+        if (!style.empty()) {
+            bar.style(style);
+        }
+        for (int64_t i = 0; i < 100'000; i++) {
+            bar.push();
+        }
+    }
+    return {counting.bytes, counting.text};
+}
+
+// the line on a terminal after text, one utf-8 character a cell. Knows '\r', '\n', and the
+// "\x1b[<n>C" and "\x1b[K" of diff_frame
+std::vector<std::string> screen(const std::string &text) {
+    std::vector<std::vector<std::string>> lines(1);
+    std::size_t cursor = 0;
+    for (std::size_t i = 0; i < text.size();) {
+        auto &line = lines.back();
+        char c = text[i];
+        if (c == '\r') {
+            cursor = 0;
+            i++;
+        } else if (c == '\n') {
+            lines.emplace_back();
+            cursor = 0;
+            i++;
+        } else if (c == '\x1b') {
+            std::size_t end = text.find_first_of("CK", i);
+            if (text[end] == 'C') {
+                cursor += std::stoul(text.substr(i + 2, end - i - 2));
+            } else {
+                line.resize(std::min(line.size(), cursor));
+            }
+            i = end + 1;
+        } else {
+            std::size_t size = progress::detail::utf8_length(c);
+            if (line.size() <= cursor) {
+                line.resize(cursor + 1, " ");
+            }
+            line[cursor++] = text.substr(i, size);
+            i += size;
+        }
+    }
+    std::vector<std::string> result;
+    for (auto &line : lines) {
+        std::string joined;
+        for (auto &cell : line) {
+            joined += cell;
+        }
+        result.push_back(joined);
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(differential_bytes) {
+    Run full = run(false, {});
+    Run differential = run(true, {});
+    // the counts and the bar change a few characters a tick, the rest of the line stays
+    CHECK(differential.bytes * 5 < full.bytes);
+    CHECK(screen(differential.text) == screen(full.text));
+}
+
+TEST(differential_bytes_utf8) {
+    Run full = run(false, progress::eighth_blocks);
+    Run differential = run(true, progress::eighth_blocks);
+    CHECK(differential.bytes * 3 < full.bytes);
+    CHECK(screen(differential.text) == screen(full.text));
+}
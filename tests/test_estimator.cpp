@@ -0,0 +1,21 @@
+// the smoothed rate of an unknown total: the first sample covers microseconds, it mustn't stand in
+// for the seconds after it
+
+#include <chrono>
+#include <cstdint>
+
+#include "check.hpp"
+#include "progress.hpp"
+
+TEST(ewma_warm_up) {
+    using namespace std::chrono_literals;
+    progress::EwmaEstimator estimator;
+    // one count in the first microsecond, a million a second at that
+    estimator.sample(1us, 1);
+    // then 12k a second for 4 seconds, sampled every 100ms
+    for (int64_t i = 1; i <= 40; i++) {
+        estimator.sample(1us + i * 100ms, 1 + i * 1200);
+    }
+    double rate = estimator.rate().per_second;
+    CHECK(rate > 11'900. && rate < 12'100.);
+}
@@ -0,0 +1,114 @@
+// instrument() samples the latency without printing any more lines than ticks() asks for, and
+// reports it at the end in every output mode
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "check.hpp"
+#include "multi.hpp"
+#include "progress.hpp"
+
+namespace {
+
+int64_t lines(int64_t every) {
+    std::ostringstream out;
+    {
+        progress::Progress bar(1000, 10, out);
+        bar.output(progress::Output::terminal).differential(false);
+        if (every > 0) {
+            bar.instrument(every);
+        }
+        for (int64_t i = 0; i < 1000; i++) {
+            bar.push();
+        }
+        // only the renders, not the report
+        std::string text = out.str();
+        return std::count(text.begin(), text.end(), '\r');
+    }
+}
+
+}  // namespace
+
+TEST(instrument_ticks) {
+    int64_t plain = lines(0);
+    CHECK_EQ(plain, 11);
+    CHECK_EQ(lines(10), plain);
+    CHECK_EQ(lines(1), plain);
+}
+
+TEST(instrument_samples) {
+    std::ostringstream out;
+    progress::Progress bar(1000, 10, out);
+    bar.output(progress::Output::terminal).instrument(1);
+    for (int64_t i = 0; i < 1000; i++) {
+        bar.push();
+    }
+    // every increment sampled, though only 11 lines were printed
+    CHECK_EQ(bar.report().count, 1000);
+    CHECK(bar.report().max.count() > 0);
+}
+
+namespace {
+
+// counts nothing, only that the bar sent its counts
+class NullCountSink : public progress::CountSink {
+public:
+    std::size_t attach(std::string_view, int64_t) override { return 0; }
+    void count(std::size_t, int64_t) override {}
+    void detach(std::size_t, int64_t) override {}
+};
+
+}  // namespace
+
+TEST(report_json) {
+    std::ostringstream out;
+    {
+        progress::Progress bar(1000, 10, out);
+        bar.output(progress::Output::json).min_interval(std::chrono::seconds(0)).instrument(1);
+        for (int64_t i = 0; i < 1000; i++) {
+            bar.push();
+        }
+    }
+    std::string text = out.str();
+    CHECK(text.find("{\"name\":\"Progress\",\"report\":{\"count\":1000,\"wall\":") !=
+          std::string::npos);
+    CHECK(text.find(",\"max_ns\":") != std::string::npos);
+    // still one json object per line
+    CHECK(text.ends_with("}}\n"));
+}
+
+TEST(report_group) {
+    std::ostringstream out;
+    {
+        progress::MultiProgress bars(out);
+        progress::Progress bar(1000, 10, out);
+        bar.name("grouped").group(bars).instrument(1);
+        for (int64_t i = 0; i < 1000; i++) {
+            bar.push();
+        }
+    }
+    CHECK(out.str().find("\rgrouped took ") != std::string::npos);
+    CHECK(out.str().find(", 1000 at ") != std::string::npos);
+}
+
+TEST(report_publish) {
+    NullCountSink sink;
+    std::ostringstream out;
+    {
+        progress::Progress bar(1000, 10, out);
+        bar.name("published").publish(sink);
+        bar.instrument(1);
+        for (int64_t i = 0; i < 1000; i++) {
+            bar.push();
+        }
+    }
+    // the report and nothing else
+    std::string text = out.str();
+    CHECK(text.starts_with("published took "));
+    CHECK_EQ(std::count(text.begin(), text.end(), '\n'), 1);
+}
@@ -0,0 +1,61 @@
+// totals near 2^40 and 2^63: the tick and ETA arithmetic mustn't overflow
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "check.hpp"
+#include "progress.hpp"
+
+namespace {
+
+constexpr int64_t max = std::numeric_limits<int64_t>::max();
+
+// the lines a bar printed for every add(), full lines so they can be searched
+std::string run(int64_t total, std::initializer_list<int64_t> adds) {
+    std::ostringstream out;
+    {
+        progress::Progress bar(total, 100, out);
+        bar.output(progress::Output::terminal).differential(false);
+        for (int64_t n : adds) {
+            bar.add(n);
+        }
+    }
+    return out.str();
+}
+
+}  // namespace
+
+TEST(muldiv) {
+    using progress::detail::muldiv;
+    using progress::detail::muldiv_ceil;
+    CHECK_EQ(muldiv(int64_t{1} << 40, 100, int64_t{1} << 40), 100);
+    CHECK_EQ(muldiv(max, 100, max), 100);
+    CHECK_EQ(muldiv(max - 1, 100, max), 99);
+    CHECK_EQ(muldiv(max, max, max), max);
+    // saturates instead of wrapping
+    CHECK_EQ(muldiv(max, 2, 1), max);
+    CHECK_EQ(muldiv_ceil(1, max, 2), max / 2 + 1);
+    CHECK_EQ(muldiv_ceil(99, max, 100), muldiv(99, max, 100) + 1);
+    CHECK_EQ(muldiv_ceil(max, max, max), max);
+}
+
+TEST(total_2_40) {
+    constexpr int64_t total = int64_t{1} << 40;
+    std::string out = run(total, {total / 2, total / 2});
+    CHECK(out.find(" 549755813888 / 1099511627776   50%") != std::string::npos);
+    CHECK(out.find(" 1099511627776 / 1099511627776  100%") != std::string::npos);
+    CHECK(out.find('-') == std::string::npos);
+}
+
+TEST(total_2_63) {
+    std::string out = run(max, {max / 2, max / 2 + 1});
+    CHECK(out.find(" 4611686018427387903 / 9223372036854775807   49%") != std::string::npos);
+    CHECK(out.find(" 9223372036854775807 / 9223372036854775807  100%") != std::string::npos);
+    CHECK(out.find('-') == std::string::npos);
+
+    out = run(max - 1, {max / 2, max / 2});
+    CHECK(out.find(" 9223372036854775806 / 9223372036854775806  100%") != std::string::npos);
+    CHECK(out.find('-') == std::string::npos);
+}
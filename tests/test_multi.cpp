@@ -0,0 +1,79 @@
+// MultiProgress batches the lines of its bars into a redraw per interval, and draws the last ones
+// even when no line comes after them
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#include "check.hpp"
+#include "multi.hpp"
+
+namespace {
+
+// counts the writes, keeps the text. Only the count may be read while the thread writes
+class WriteCounter : public std::streambuf {
+public:
+    std::atomic<int64_t> writes{0};
+    std::string text;
+
+protected:
+    int overflow(int c) override {
+        writes++;
+        text.push_back(static_cast<char>(c));
+        return c;
+    }
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        writes++;
+        text.append(s, static_cast<std::size_t>(n));
+        return n;
+    }
+};
+
+}  // namespace
+
+TEST(multi_batched) {
+    WriteCounter counter;
+    std::ostream out(&counter);
+    {
+        progress::MultiProgress bars(out);
+        bars.min_interval(std::chrono::seconds(10));
+        progress::Progress outer(3);
+        for ([[maybe_unused]] int i : outer.name("outer").group(bars)) {
+            progress::Progress inner(100);
+            inner.name("inner").group(bars);
+            for (int j = 0; j < 100; j++) {
+                inner.push();
+            }
+        }
+    }
+    // the first line, a redraw for each bar that's done, the one of the destructor. Not one for
+    // every line of every bar
+    CHECK(counter.writes.load() <= 6);
+    CHECK(counter.text.find(" inner : [####################] 100 / 100  100%") !=
+          std::string::npos);
+    CHECK(counter.text.find(" outer : [####################] 3 / 3  100%") != std::string::npos);
+}
+
+TEST(multi_pending) {
+    WriteCounter counter;
+    std::ostream out(&counter);
+    {
+        progress::MultiProgress bars(out);
+        bars.min_interval(std::chrono::milliseconds(20));
+        std::size_t row = bars.attach();
+        bars.line(row, "first");
+        CHECK_EQ(counter.writes.load(), 1);
+        // too soon for a redraw, the thread has to draw it
+        bars.line(row, "second");
+        for (int i = 0; i < 100 && counter.writes.load() < 2; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CHECK_EQ(counter.writes.load(), 2);
+        bars.detach(row);
+    }
+    CHECK(counter.text.find("\rsecond\x1b[K\n") != std::string::npos);
+}
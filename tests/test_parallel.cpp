@@ -0,0 +1,69 @@
+// more threads than ConcurrentProgress has slots, and still not a single count lost
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+#include "parallel.hpp"
+
+namespace {
+
+// ConcurrentProgress has max(8, 2 * cores) slots to hand out, this is well past that
+unsigned oversubscribed() { return 2 * std::max(8u, 2 * std::thread::hardware_concurrency()) + 3; }
+
+}  // namespace
+
+TEST(concurrent_oversubscribed) {
+    const unsigned threads = oversubscribed();
+    constexpr int64_t per_thread = 200'000;
+    std::ostringstream out;
+    progress::ConcurrentProgress bar(threads * per_thread, out);
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&] {
+            for (int64_t i = 0; i < per_thread; i++) {
+                bar.add();
+            }
+        });
+    }
+    for (auto &thread : pool) {
+        thread.join();
+    }
+    CHECK_EQ(bar.count(), threads * per_thread);
+}
+
+TEST(concurrent_one_thread) {
+    // one thread tries to print once per tick, however many slots the machine has
+    std::ostringstream out;
+    progress::ConcurrentProgress bar(1000, 10, out);
+    for (int i = 0; i < 99; i++) {
+        bar.add();
+    }
+    // the first add tried, the next try is a tick of 100 later
+    CHECK_EQ(bar.bar().count(), 1);
+    for (int i = 0; i < 2; i++) {
+        bar.add();
+    }
+    CHECK_EQ(bar.bar().count(), 101);
+}
+
+TEST(parallel_oversubscribed) {
+    constexpr int64_t n = 1'000'003;
+    std::ostringstream out;
+    progress::ParallelConfig config;
+    config.threads = oversubscribed();
+    config.chunk = 7;
+    config.report = false;
+    auto stats = progress::parallel_for(n, [](int64_t) {}, config, out);
+    int64_t items = 0;
+    for (const auto &worker : stats) {
+        items += worker.items;
+    }
+    CHECK_EQ(items, n);
+    // the last line the bar printed has the final count
+    CHECK(out.str().find(" 1000003 / 1000003 ") != std::string::npos);
+}
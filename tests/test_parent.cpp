@@ -0,0 +1,80 @@
+// a stage publishing to a ParentProgress hears from it on its ticks, not on every push
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "check.hpp"
+#include "parent.hpp"
+
+namespace {
+
+// counts how often a bar calls it
+class CallCounter : public progress::CountSink {
+public:
+    int64_t counts{0};
+    int64_t last{0};
+
+    std::size_t attach(std::string_view, int64_t) override { return 0; }
+    void count(std::size_t, int64_t counter) override {
+        counts++;
+        last = counter;
+    }
+    void detach(std::size_t, int64_t counter) override { last = counter; }
+};
+
+}  // namespace
+
+TEST(publish_ticks) {
+    CallCounter sink;
+    {
+        progress::Progress stage(1'000'000);
+        stage.publish(sink);
+        for (int64_t i = 0; i < 1'000'000; i++) {
+            stage.push();
+        }
+    }
+    CHECK(sink.counts <= 1001);
+    CHECK_EQ(sink.last, 1'000'000);
+
+    // ticks() of its own are kept
+    CallCounter own;
+    {
+        progress::Progress stage(5000, 2500);
+        stage.publish(own);
+        for (int64_t i = 0; i < 5000; i++) {
+            stage.push();
+        }
+    }
+    // and the first, tick 0
+    CHECK_EQ(own.counts, 2501);
+}
+
+TEST(parent_weights) {
+    std::ostringstream out;
+    progress::ParentProgress pipeline(out);
+    pipeline.name("pipeline").child("load", 1).child("transform", 3);
+    pipeline.bar().output(progress::Output::terminal).differential(false);
+    {
+        progress::Progress load(1'000'000);
+        load.name("load").publish(pipeline);
+        for (int64_t i = 0; i < 1'000'000; i++) {
+            load.push();
+        }
+    }
+    // load done, a quarter of the weight
+    CHECK(out.str().find(" 1.0 / 4.0   25%") != std::string::npos);
+    {
+        progress::Progress transform(10);
+        transform.name("transform").publish(pipeline);
+        for (int64_t i = 0; i < 5; i++) {
+            transform.push();
+        }
+        CHECK(out.str().find(" 2.5 / 4.0   62%") != std::string::npos);
+        for (int64_t i = 0; i < 5; i++) {
+            transform.push();
+        }
+    }
+    CHECK(out.str().find(" 4.0 / 4.0  100%") != std::string::npos);
+}
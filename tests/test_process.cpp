@@ -0,0 +1,35 @@
+// forked workers each add their share, the parent's total has all of it
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include "check.hpp"
+#include "process.hpp"
+
+TEST(process_total) {
+    constexpr std::size_t workers = 4;
+    constexpr int64_t share = 250'000;
+    std::ostringstream out;
+    progress::ProcessProgress bar(workers * share, workers, out);
+    std::vector<pid_t> pids;
+    for (std::size_t w = 0; w < workers; w++) {
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            auto worker = bar.worker(w);
+            for (int64_t i = 0; i < share; i++) {
+                worker.add(1);
+            }
+            ::_exit(0);
+        }
+        CHECK(pid > 0);
+        pids.push_back(pid);
+    }
+    bar.watch(pids, std::chrono::milliseconds(10));
+    CHECK_EQ(bar.count(), static_cast<int64_t>(workers) * share);
+    CHECK_EQ(bar.bar().count(), static_cast<int64_t>(workers) * share);
+}
@@ -0,0 +1,45 @@
+// ticks(0) is a bar that never prints, which mustn't divide by the zero ticks on the way out
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "check.hpp"
+#include "concurrent.hpp"
+#include "progress.hpp"
+
+TEST(zero_ticks) {
+    std::ostringstream out;
+    {
+        progress::Progress bar(100, 0, out);
+        bar.output(progress::Output::terminal);
+        for (int i = 0; i < 50; i++) {
+            bar.push();
+        }
+    }
+    CHECK(out.str().find(" / 100") == std::string::npos);
+}
+
+TEST(zero_ticks_concurrent) {
+    std::ostringstream out;
+    {
+        progress::ConcurrentProgress bar(100, 0, out);
+        bar.add(50);
+    }
+    CHECK(out.str().find(" / 100") == std::string::npos);
+}
+
+TEST(zero_ticks_async) {
+    // the renderer thread prints by the clock, with no ticks the percentage comes from the counter
+    std::ostringstream out;
+    {
+        progress::Progress bar(100, 0, out);
+        bar.output(progress::Output::terminal).differential(false);
+        bar.async(std::chrono::milliseconds(1));
+        bar.add(50);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    CHECK(out.str().find(" 50 / 100   50%") != std::string::npos);
+}
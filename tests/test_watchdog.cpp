@@ -0,0 +1,147 @@
+// the watchdog without its thread, on a fake clock: check() sees exactly the counts and times the
+// test sets up
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "watchdog.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+std::chrono::time_point<std::chrono::high_resolution_clock> fake_now;
+
+std::chrono::time_point<std::chrono::high_resolution_clock> fake_clock() { return fake_now; }
+
+progress::WatchdogConfig config() {
+    progress::WatchdogConfig config;
+    config.deadline = 10s;
+    config.slowdown = 0.1;
+    config.half_life = 5s;
+    config.poll = 0ms;
+    config.clock = fake_clock;
+    return config;
+}
+
+}  // namespace
+
+TEST(watchdog_stall) {
+    fake_now = {};
+    test::NullBuffer null;
+    std::ostream bar_out(&null);
+    std::ostringstream out;
+    progress::Progress bar(1000, bar_out);
+    bar.name("loading");
+    // the first progress after a stall is slow by any measure, that's the other test
+    progress::WatchdogConfig stall = config();
+    stall.slowdown = 0;
+    std::vector<progress::WatchdogEvent> events;
+    progress::Watchdog watchdog(
+        bar, stall, [&](const progress::WatchdogEvent &event) { events.push_back(event); }, out);
+
+    bar.add(100);
+    fake_now += 1s;
+    CHECK(!watchdog.check());
+    // no progress, but not for the deadline yet
+    fake_now += 9s;
+    CHECK(!watchdog.check());
+    fake_now += 1s;
+    CHECK(watchdog.check());
+    CHECK_EQ(events.size(), std::size_t{1});
+    CHECK(events[0].alarm == progress::Alarm::stall);
+    CHECK_EQ(events[0].count, 100);
+    CHECK(events[0].last_progress - decltype(fake_now){} == 1s);
+    CHECK(out.str().find("!! loading stalled, no progress for 0m:10s, last at 0m:1s with 100") !=
+          std::string::npos);
+
+    // once per stall
+    fake_now += 30s;
+    CHECK(!watchdog.check());
+    CHECK_EQ(events.size(), std::size_t{1});
+
+    // and again after it recovered
+    bar.add(1);
+    fake_now += 1s;
+    CHECK(!watchdog.check());
+    fake_now += 10s;
+    CHECK(watchdog.check());
+    CHECK_EQ(events.size(), std::size_t{2});
+
+    // a finished bar doesn't hang
+    bar.add(899);
+    fake_now += 1s;
+    watchdog.check();
+    fake_now += 60s;
+    CHECK(!watchdog.check());
+    CHECK_EQ(events.size(), std::size_t{2});
+}
+
+TEST(watchdog_slowdown) {
+    fake_now = {};
+    test::NullBuffer null;
+    std::ostream bar_out(&null);
+    std::ostringstream out;
+    progress::Progress bar(1'000'000, bar_out);
+    std::vector<progress::WatchdogEvent> events;
+    progress::Watchdog watchdog(
+        bar, config(), [&](const progress::WatchdogEvent &event) { events.push_back(event); }, out);
+
+    // 1000/s for longer than the half life
+    for (int i = 0; i < 10; i++) {
+        bar.add(1000);
+        fake_now += 1s;
+        CHECK(!watchdog.check());
+    }
+    CHECK(events.empty());
+
+    // 50/s is below a tenth of it
+    bar.add(50);
+    fake_now += 1s;
+    CHECK(watchdog.check());
+    CHECK_EQ(events.size(), std::size_t{1});
+    CHECK(events[0].alarm == progress::Alarm::slowdown);
+    CHECK_EQ(events[0].count, 10050);
+    CHECK(events[0].rate == 50.);
+    CHECK(events[0].smoothed > 900.);
+    CHECK(out.str().find("!! Progress slowed down to 50/s from ") != std::string::npos);
+
+    // still slow, reported once
+    bar.add(50);
+    fake_now += 1s;
+    CHECK(!watchdog.check());
+
+    // back to speed, then slow again
+    for (int i = 0; i < 3; i++) {
+        bar.add(1000);
+        fake_now += 1s;
+        CHECK(!watchdog.check());
+    }
+    bar.add(10);
+    fake_now += 1s;
+    CHECK(watchdog.check());
+    CHECK_EQ(events.size(), std::size_t{2});
+}
+
+TEST(watchdog_early) {
+    // no slowdown before the half life passed, the smoothed rate means nothing yet
+    fake_now = {};
+    test::NullBuffer null;
+    std::ostream bar_out(&null);
+    progress::Progress bar(1'000'000, bar_out);
+    progress::WatchdogConfig quiet = config();
+    quiet.print = false;
+    int alarms = 0;
+    progress::Watchdog watchdog(bar, quiet, [&](const progress::WatchdogEvent &) { alarms++; });
+    bar.add(1000);
+    fake_now += 1s;
+    watchdog.check();
+    bar.add(1);
+    fake_now += 1s;
+    CHECK(!watchdog.check());
+    CHECK_EQ(alarms, 0);
+}